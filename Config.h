@@ -7,6 +7,21 @@
 
 #define LOGGING_ENABLED 1
 
+//Lowest level compiled in: 0 DEBUG, 1 INFO, 2 WARNING, 3 ERROR
+#define LOG_MIN_LEVEL 0
+
+//Messages per second each LOG call site may emit through the async backend; 0 disables rate limiting
+#define LOG_RATE_LIMIT 20
+
 #define MAX_NUM_MODULES 8
 
+//Set to 0 to compile the codec metrics hooks out
+#define METRICS_ENABLED 1
+
+//Encode/decode calls per thread between two latency samples
+#define METRICS_LATENCY_SAMPLE_EVERY 128
+
+//Set to 0 to build without the PCLMULQDQ CRC16 kernel
+#define CRC16_ENABLE_CLMUL 1
+
 #endif //SMARTDRIVE_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,505 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/BinaryProtocol.h"
+#include "../src/CompactCodec.h"
+#include "../src/CompressedTelemetry.h"
+#include "../src/FrameCodec.h"
+#include "../src/FrameStreamDecoder.h"
+#include "../src/TelemetryPipeline.h"
+#include "../utils/CRC16.h"
+#include "../utils/ObjectPool.h"
+
+// Every heap allocation in the process is counted, so a benchmark can report allocations per operation
+static std::atomic<uint64_t> allocationCount{0};
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+// Keeps the compiler from discarding results the benchmark does not otherwise use
+template<typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    uint64_t operations;
+    double seconds;
+    double nsPerOp;
+    double opsPerSecond;
+    double bytesPerSecond;
+    double allocationsPerOp;
+};
+
+struct Options {
+    double minSeconds = 0.2;
+    std::string filter;
+    std::string jsonPath;
+    bool jsonToStdout = false;
+};
+
+static Options options;
+static std::vector<Result> results;
+
+// What a benchmark body did when its unit of work does not divide the batch evenly
+struct Work {
+    uint64_t operations;
+    uint64_t bytes;
+};
+
+static void account(const Work& work, uint64_t, uint64_t& operations, uint64_t& bytes) {
+    operations += work.operations;
+    bytes += work.bytes;
+}
+
+static void account(const uint64_t workBytes, const uint64_t batch, uint64_t& operations, uint64_t& bytes) {
+    operations += batch;
+    bytes += workBytes;
+}
+
+// Runs fn(batch) in growing batches until minSeconds have elapsed. fn performs batch operations and
+// returns the number of payload bytes it processed, or a Work with the operations it actually ran.
+template<typename Fn>
+void run(const std::string& name, Fn&& fn) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+    using Clock = std::chrono::steady_clock;
+    fn(16);  // warm up caches and lazily initialised state (CRC engine selection, thread start-up)
+
+    uint64_t batch = 16;
+    uint64_t operations = 0;
+    uint64_t bytes = 0;
+    const uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    const Clock::time_point start = Clock::now();
+    double elapsed = 0.0;
+    while (elapsed < options.minSeconds) {
+        account(fn(batch), batch, operations, bytes);
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (elapsed < options.minSeconds / 10) batch *= 2;
+    }
+    const uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+    Result r{name, operations, elapsed, elapsed * 1e9 / static_cast<double>(operations),
+             static_cast<double>(operations) / elapsed, static_cast<double>(bytes) / elapsed,
+             static_cast<double>(allocations) / static_cast<double>(operations)};
+    results.push_back(r);
+
+    if (!options.jsonToStdout) {
+        std::cout << std::left << std::setw(44) << r.name << std::right << std::fixed
+                  << std::setw(10) << std::setprecision(1) << r.nsPerOp << " ns/op"
+                  << std::setw(11) << std::setprecision(1) << r.bytesPerSecond / 1e6 << " MB/s"
+                  << std::setw(8) << std::setprecision(2) << r.allocationsPerOp << " allocs/op" << std::endl;
+    }
+}
+
+template<typename T>
+void benchRoundTrip(const char* label, const T& value) {
+    constexpr size_t frameSize = FrameCodec::frameSize<T>;
+    uint8_t frame[frameSize];
+
+    run(std::string("serialize/") + label, [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            FrameCodec::serialize(value, frame, sizeof(frame));
+            keep(frame);
+        }
+        return n * frameSize;
+    });
+
+    FrameCodec::serialize(value, frame, sizeof(frame));
+    run(std::string("deserialize/") + label, [&](uint64_t n) {
+        T out;
+        for (uint64_t i = 0; i < n; ++i) {
+            FrameCodec::deserialize(frame, sizeof(frame), out);
+            keep(out);
+        }
+        return n * frameSize;
+    });
+}
+
+void benchFrameTypes() {
+    Command cmd{};
+    cmd.commandType = 7;
+    cmd.w = 1.0f;
+    DiscoveryResponse discovery{};
+    discovery.moduleCount = MAX_NUM_MODULES;
+    ValueSource value;
+    value.pack<float>(3.25f);
+    TelemetryData telemetry;
+    telemetry.sourceID = 12;
+    telemetry.timestamp = 123456;
+    telemetry.pack<int32_t>(-42);
+    SettingsData settings;
+    settings.settingsID = 3;
+    settings.pack<uint16_t>(500);
+
+    benchRoundTrip("command", cmd);
+    benchRoundTrip("discovery", discovery);
+    benchRoundTrip("value", value);
+    benchRoundTrip("telemetry", telemetry);
+    benchRoundTrip("settings", settings);
+
+    // The type-erased path, as most application code calls it
+    const BinaryProtocol binary;
+    const IProtocol& protocol = binary;
+    run("iprotocol/serialize/telemetry", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            SerializedData out = protocol.serializeTelemetry(telemetry);
+            keep(out);
+        }
+        return n * FrameCodec::frameSize<TelemetryData>;
+    });
+
+    std::vector<TelemetryData> samples(64, telemetry);
+    std::vector<uint8_t> batch(samples.size() * FrameCodec::frameSize<TelemetryData>);
+    run("batch/serialize/telemetry", [&](uint64_t n) {
+        Work work{0, 0};
+        while (work.operations < n) {
+            FrameCodec::serializeBatch(samples.data(), samples.size(), batch.data(), batch.size());
+            keep(batch[0]);
+            work.operations += samples.size();
+            work.bytes += samples.size() * FrameCodec::frameSize<TelemetryData>;
+        }
+        return work;
+    });
+
+    const LinkCodec compact = [] {
+        LinkCodec link;
+        link.setEncoding(WireEncoding::COMPACT);
+        return link;
+    }();
+    uint8_t compactFrame[ProtocolConstants::MAX_FRAME_SIZE];
+    run("compact/serialize/telemetry", [&](uint64_t n) {
+        size_t bytes = 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            bytes += compact.serialize(telemetry, compactFrame, sizeof(compactFrame));
+            keep(compactFrame);
+        }
+        return bytes;
+    });
+
+    // Ramp-like float series, 16 sources per tick
+    for (size_t i = 0; i < samples.size(); ++i) {
+        samples[i].sourceID = static_cast<uint16_t>(i % 16);
+        samples[i].timestamp = static_cast<uint32_t>(1000 + (i / 16) * 10);
+        samples[i].pack<float>(static_cast<float>(i / 16) * 0.5f);
+    }
+    uint8_t compressed[ProtocolConstants::MAX_FRAME_SIZE];
+    size_t consumed = 0;
+    const size_t compressedSize = CompressedTelemetry::encode(samples.data(), samples.size(), compressed,
+                                                              sizeof(compressed), consumed);
+    run("compressed/encode/telemetry-sample", [&](uint64_t n) {
+        Work work{0, 0};
+        while (work.operations < n) {
+            size_t c = 0;
+            work.bytes += CompressedTelemetry::encode(samples.data(), samples.size(), compressed, sizeof(compressed), c);
+            keep(compressed);
+            if (c == 0) break;
+            work.operations += c;
+        }
+        return work;
+    });
+    run("compressed/decode/telemetry-sample", [&](uint64_t n) {
+        TelemetryData out[CompressedTelemetry::MAX_SAMPLES];
+        Work work{0, 0};
+        while (work.operations < n) {
+            size_t decoded = 0;
+            CompressedTelemetry::decode(compressed, compressedSize, out, CompressedTelemetry::MAX_SAMPLES, decoded);
+            keep(out);
+            if (decoded == 0) break;
+            work.operations += decoded;
+            work.bytes += compressedSize;
+        }
+        return work;
+    });
+
+    // Decoded objects that outlive the call: heap versus the library's pool and arena
+    uint8_t telemetryFrame[FrameCodec::frameSize<TelemetryData>];
+    FrameCodec::serialize(telemetry, telemetryFrame, sizeof(telemetryFrame));
+    run("alloc/heap/decode-telemetry", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            std::unique_ptr<TelemetryData> t(new TelemetryData);
+            FrameCodec::deserialize(telemetryFrame, sizeof(telemetryFrame), *t);
+            keep(t);
+        }
+        return n * sizeof(telemetryFrame);
+    });
+    run("alloc/pool/decode-telemetry", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            PoolPtr<TelemetryData> t = ObjectPool::make<TelemetryData>();
+            FrameCodec::deserialize(telemetryFrame, sizeof(telemetryFrame), *t);
+            keep(t);
+        }
+        return n * sizeof(telemetryFrame);
+    });
+    FrameArena arena;
+    run("alloc/arena/decode-telemetry", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            if (i % 1024 == 0) arena.reset();
+            TelemetryData* t = arena.make<TelemetryData>();
+            FrameCodec::deserialize(telemetryFrame, sizeof(telemetryFrame), *t);
+            keep(t);
+        }
+        return n * sizeof(telemetryFrame);
+    });
+}
+
+void benchCrc() {
+    const size_t sizes[] = {8, 26, 64, 256, 4096, 65536};
+    const CRC16::Engine engines[] = {CRC16::Engine::BITWISE, CRC16::Engine::TABLE,
+                                     CRC16::Engine::SLICING_BY_8, CRC16::Engine::CLMUL};
+    std::vector<uint8_t> data(65536);
+    std::mt19937 rng(1);
+    for (uint8_t& b : data) b = static_cast<uint8_t>(rng());
+
+    for (const CRC16::Engine engine : engines) {
+        if (!CRC16::isSupported(engine)) continue;
+        for (const size_t size : sizes) {
+            if (engine == CRC16::Engine::BITWISE && size > 4096) continue;
+            run(std::string("crc16/") + CRC16::engineToString(engine) + "/" + std::to_string(size), [&](uint64_t n) {
+                uint16_t crc = 0;
+                for (uint64_t i = 0; i < n; ++i) {
+                    crc ^= CRC16::update(engine, CRC16::INITIAL_VALUE, data.data(), size);
+                }
+                keep(crc);
+                return n * size;
+            });
+        }
+    }
+}
+
+// A stream of mixed frames where a fraction of them has one byte flipped
+std::vector<uint8_t> buildStream(const double corruptionRate) {
+    std::vector<uint8_t> stream;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    for (uint32_t i = 0; i < 4096; ++i) {
+        uint8_t frame[ProtocolConstants::MAX_FRAME_SIZE];
+        size_t size;
+        if (i % 3 == 0) {
+            Command cmd{};
+            cmd.commandType = static_cast<uint16_t>(i);
+            size = FrameCodec::serialize(cmd, frame, sizeof(frame));
+        } else {
+            TelemetryData telemetry;
+            telemetry.sourceID = static_cast<uint16_t>(i % 32);
+            telemetry.timestamp = i;
+            telemetry.pack<float>(static_cast<float>(i));
+            size = FrameCodec::serialize(telemetry, frame, sizeof(frame));
+        }
+        if (chance(rng) < corruptionRate) frame[rng() % size] ^= 0x5A;
+        stream.insert(stream.end(), frame, frame + size);
+    }
+    return stream;
+}
+
+void benchStreamDecoder() {
+    const double rates[] = {0.0, 0.001, 0.01, 0.1};
+    for (const double rate : rates) {
+        const std::vector<uint8_t> stream = buildStream(rate);
+        FrameStreamDecoder decoder;
+        static uint64_t handled = 0;
+        const FrameHandler count = [](void*, const uint8_t*, size_t) { handled++; };
+        decoder.setHandler(ProtocolConstants::FrameType::COMMAND, count);
+        decoder.setHandler(ProtocolConstants::FrameType::TELEMETRY, count);
+
+        std::ostringstream name;
+        name << "stream-decoder/corruption-" << rate * 100 << "%/256B-chunks";
+        run(name.str(), [&](uint64_t n) {
+            // One operation is one 256-byte read from the link
+            size_t offset = 0;
+            for (uint64_t i = 0; i < n; ++i) {
+                if (offset + 256 > stream.size()) offset = 0;
+                decoder.feed(&stream[offset], 256);
+                offset += 256;
+            }
+            return n * 256;
+        });
+        keep(handled);
+    }
+}
+
+// Threads started once, outside any timed region; each go() releases all of them on one batch
+// and waits until every one has finished its share
+template<typename Fn>
+class WorkerTeam {
+public:
+    WorkerTeam(const unsigned count, Fn work) : count(count), work(work) {
+        for (unsigned index = 0; index < count; ++index) {
+            threads.emplace_back([this, index] { loop(index); });
+        }
+    }
+
+    ~WorkerTeam() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (std::thread& t : threads) t.join();
+    }
+
+    void go(const uint64_t n) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch = n;
+            finished.store(0, std::memory_order_relaxed);
+            generation++;
+        }
+        start.notify_all();
+        while (finished.load(std::memory_order_acquire) < count) std::this_thread::yield();
+    }
+
+private:
+    void loop(const unsigned index) {
+        uint64_t seen = 0;
+        for (;;) {
+            uint64_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                n = batch;
+            }
+            work(index, n);
+            finished.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    const unsigned count;
+    Fn work;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start;
+    uint64_t generation = 0;
+    uint64_t batch = 0;
+    bool stopping = false;
+    std::atomic<unsigned> finished{0};
+};
+
+void benchThreads() {
+    const unsigned counts[] = {1, 2, 4, 8};
+    TelemetryData telemetry;
+    telemetry.pack<float>(1.0f);
+
+    // Independent encoders sharing one protocol object
+    const BinaryProtocol protocol;
+    for (const unsigned threads : counts) {
+        auto work = [&protocol, &telemetry, threads](unsigned t, uint64_t n) {
+            uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+            TelemetryData local = telemetry;
+            local.sourceID = static_cast<uint16_t>(t);
+            for (uint64_t i = t; i < n; i += threads) {
+                protocol.serializeTelemetry(local, frame, sizeof(frame));
+                protocol.deserializeTelemetry(frame, sizeof(frame), local);
+            }
+        };
+        WorkerTeam<decltype(work)> team(threads, work);
+        run("threads/" + std::to_string(threads) + "/serialize+deserialize", [&](uint64_t n) {
+            team.go(n);
+            return n * FrameCodec::frameSize<TelemetryData>;
+        });
+    }
+
+    // End-to-end pipeline throughput: one submitting thread, varying decode workers
+    for (const unsigned workers : counts) {
+        static std::atomic<uint64_t> delivered{0};
+        TelemetryPipeline<> pipeline(workers, [](void*, const TelemetryData&) {
+            delivered.fetch_add(1, std::memory_order_relaxed);
+        });
+        pipeline.start();
+        uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+        run("pipeline/" + std::to_string(workers) + "-workers", [&](uint64_t n) {
+            const uint64_t target = delivered.load() + n;
+            for (uint64_t i = 0; i < n; ++i) {
+                telemetry.sourceID = static_cast<uint16_t>(i & 63);
+                FrameCodec::serialize(telemetry, frame, sizeof(frame));
+                while (!pipeline.submit(frame, sizeof(frame))) std::this_thread::yield();
+            }
+            while (delivered.load() < target) std::this_thread::yield();
+            return n * sizeof(frame);
+        });
+        pipeline.stop();
+    }
+}
+
+void writeJson(std::ostream& out) {
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"operations\": " << r.operations
+            << std::setprecision(6) << std::defaultfloat
+            << ", \"seconds\": " << r.seconds
+            << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"ops_per_second\": " << r.opsPerSecond
+            << ", \"bytes_per_second\": " << r.bytesPerSecond
+            << ", \"allocations_per_op\": " << r.allocationsPerOp << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+void usage(const char* argv0) {
+    std::cerr << "Usage: " << argv0 << " [--filter <substring>] [--min-time <seconds>] [--json [path]]\n"
+              << "  --json without a path writes JSON to stdout instead of the table" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minSeconds = std::atof(argv[++i]);
+        } else if (arg == "--json") {
+            if (i + 1 < argc && argv[i + 1][0] != '-') options.jsonPath = argv[++i];
+            else options.jsonToStdout = true;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!options.jsonToStdout) {
+        std::cout << "=== SmartDrive Benchmarks (CRC engine: " << CRC16::engineToString(CRC16::activeEngine())
+                  << ", " << std::thread::hardware_concurrency() << " hardware threads) ===" << std::endl;
+    }
+
+    benchFrameTypes();
+    benchCrc();
+    benchStreamDecoder();
+    benchThreads();
+
+    if (options.jsonToStdout) {
+        writeJson(std::cout);
+    } else if (!options.jsonPath.empty()) {
+        std::ofstream file(options.jsonPath);
+        if (!file) {
+            std::cerr << "Cannot write " << options.jsonPath << std::endl;
+            return 1;
+        }
+        writeJson(file);
+    }
+    return 0;
+}
@@ -14,17 +14,30 @@ namespace ProtocolConstants {
 
     constexpr uint16_t MAX_PAYLOAD_SIZE = 64;
 
-    constexpr uint16_t PROTOCOL_OVERHEAD = 4; //STX+TYPE(1) + LENGTH(1) + CRC(2)
+    constexpr uint16_t HEADER_SIZE = 2; //STX+TYPE(1) + LENGTH(1)
+    constexpr uint16_t CRC_SIZE = 2;
+    constexpr uint16_t PROTOCOL_OVERHEAD = HEADER_SIZE + CRC_SIZE;
     constexpr uint16_t MAX_FRAME_SIZE = MAX_PAYLOAD_SIZE + PROTOCOL_OVERHEAD;
 
+    constexpr uint8_t MAX_FRAME_TYPES = 1 << (8 - TYPE_SHIFT);
+
     enum class FrameType : uint8_t {
         COMMAND = 0x00,
         DISCOVERY = 0x01,
         TELEMETRY = 0x02,
         SETTINGS = 0x03,
-        VALUE_SOURCE = 0x04
+        VALUE_SOURCE = 0x04,
+        COMPRESSED_TELEMETRY = 0x05,
+        FRAGMENT = 0x06,
+        TRANSACTION = 0x07
     };
 
+    //Link capability announcements are COMMAND frames with a short payload: magic(2) capabilities(2).
+    //Any decoder expecting a Command rejects the length, so a legacy peer never acts on one.
+    constexpr uint8_t CAPABILITY_PAYLOAD_SIZE = 4;
+    constexpr uint16_t CAPABILITY_MAGIC = 0x4353;
+    constexpr uint16_t CAPABILITY_COMPACT_VALUES = 0x0001;
+
     constexpr uint8_t encodeHeader(FrameType type) {
         return (static_cast<uint8_t>(type) << TYPE_SHIFT) | STX_PATTERN;
     }
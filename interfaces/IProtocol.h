@@ -15,31 +15,42 @@ struct SerializedData {
     size_t size = 0;
 };
 
+//Implementations are stateless: every method is const and reentrant, so one instance can be
+//shared by any number of threads without locking.
 class IProtocol {
 public:
     virtual ~IProtocol() = default;
 
+    //The overloads taking (out, capacity) write the frame straight into the caller's buffer and
+    //return the number of bytes written, or 0 if the payload or the buffer is too small.
+    //The SerializedData overloads are convenience wrappers around them.
+
     //Command Serialization & Deserialization
-    virtual SerializedData serializeCommand(const Command& cmd) = 0;
-    virtual bool deserializeCommand(const uint8_t* data, size_t size, Command& cmdOut) = 0;
+    virtual SerializedData serializeCommand(const Command& cmd) const = 0;
+    virtual size_t serializeCommand(const Command& cmd, uint8_t* out, size_t capacity) const = 0;
+    virtual bool deserializeCommand(const uint8_t* data, size_t size, Command& cmdOut) const = 0;
 
     //Discovery Serialization & Deserialization
-    virtual SerializedData serializeDiscovery(const DiscoveryResponse& resp) = 0;
-    virtual bool deserializeDiscovery(const uint8_t* data, size_t size, DiscoveryResponse& respOut) = 0;
+    virtual SerializedData serializeDiscovery(const DiscoveryResponse& resp) const = 0;
+    virtual size_t serializeDiscovery(const DiscoveryResponse& resp, uint8_t* out, size_t capacity) const = 0;
+    virtual bool deserializeDiscovery(const uint8_t* data, size_t size, DiscoveryResponse& respOut) const = 0;
 
     //ValueSource Serialization & Deserialization
-    virtual SerializedData serializeValue(const ValueSource& value) = 0;
-    virtual bool deserializeValue(const uint8_t* data, size_t size, ValueSource& valueOut) = 0;
+    virtual SerializedData serializeValue(const ValueSource& value) const = 0;
+    virtual size_t serializeValue(const ValueSource& value, uint8_t* out, size_t capacity) const = 0;
+    virtual bool deserializeValue(const uint8_t* data, size_t size, ValueSource& valueOut) const = 0;
 
     //Telemetry Serialization & Deserialization
-    virtual SerializedData serializeTelemetry(const TelemetryData& telemetry) = 0;
-    virtual bool deserializeTelemetry(const uint8_t* data, size_t size, TelemetryData& telemetryOut) = 0;
+    virtual SerializedData serializeTelemetry(const TelemetryData& telemetry) const = 0;
+    virtual size_t serializeTelemetry(const TelemetryData& telemetry, uint8_t* out, size_t capacity) const = 0;
+    virtual bool deserializeTelemetry(const uint8_t* data, size_t size, TelemetryData& telemetryOut) const = 0;
 
     //Settings Serialization & Deserialization
-    virtual SerializedData serializeSettings(const SettingsData& settings) = 0;
-    virtual bool deserializeSettings(const uint8_t* data, size_t size, SettingsData& settingsOut) = 0;
+    virtual SerializedData serializeSettings(const SettingsData& settings) const = 0;
+    virtual size_t serializeSettings(const SettingsData& settings, uint8_t* out, size_t capacity) const = 0;
+    virtual bool deserializeSettings(const uint8_t* data, size_t size, SettingsData& settingsOut) const = 0;
 
-    virtual uint16_t computeIntegrityCode(const uint8_t* data, size_t length) = 0;
+    virtual uint16_t computeIntegrityCode(const uint8_t* data, size_t length) const = 0;
 };
 
 #endif //SMARTDRIVE_IPROTOCOL_H
\ No newline at end of file
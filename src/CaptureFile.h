@@ -0,0 +1,444 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_CAPTUREFILE_H
+#define SMARTDRIVE_CAPTUREFILE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FrameStreamDecoder.h"
+#include "../utils/Logger.h"
+
+//On-disk layout of a link capture. A file is a sequence of self-describing segments, each a whole
+//multiple of SEGMENT_ALIGNMENT so it can be mapped on its own:
+//  SegmentHeader | IndexEntry[indexCapacity] | records...
+//A record is RecordHeader followed by the raw frame bytes, padded to 8 bytes. Every INDEX_STRIDE bytes
+//of record data the segment gets an index entry, so seeking by time is a binary search over segments,
+//then over one segment's index, then a scan of at most one stride. All fields are host byte order.
+namespace CaptureFormat {
+    constexpr uint32_t SEGMENT_MAGIC = 0x50414353; //"SCAP"
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t SEGMENT_ALIGNMENT = 4096; //format unit; mappings use the runtime page size
+    constexpr size_t INDEX_STRIDE = 4096;
+    constexpr size_t RECORD_ALIGNMENT = 8;
+
+    struct SegmentHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;
+        uint32_t segmentSize;
+        uint32_t sequence;
+        uint64_t firstTimestampNs;
+        uint64_t lastTimestampNs;
+        uint32_t recordCount;
+        uint32_t dataBytes; //bytes of records after dataOffset
+        uint32_t indexCapacity;
+        uint32_t indexCount;
+        uint32_t dataOffset;
+        uint32_t reserved;
+    };
+
+    struct IndexEntry {
+        uint64_t timestampNs;
+        uint32_t offset; //relative to dataOffset
+        uint32_t recordNumber;
+    };
+
+    struct RecordHeader {
+        uint64_t timestampNs;
+        uint16_t linkId;
+        uint16_t length;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(SegmentHeader) == 56, "SegmentHeader must be exactly 56 bytes");
+    static_assert(sizeof(IndexEntry) == 16, "IndexEntry must be exactly 16 bytes");
+    static_assert(sizeof(RecordHeader) == 16, "RecordHeader must be exactly 16 bytes");
+
+    constexpr size_t recordSize(const size_t frameSize) {
+        return (sizeof(RecordHeader) + frameSize + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+    }
+
+    //Kernel page size; 16K and 64K on some arm64 and ppc64 systems
+    inline size_t pageSize() {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    constexpr uint32_t indexCapacity(const size_t segmentSize) {
+        return static_cast<uint32_t>((segmentSize - sizeof(SegmentHeader)) / (INDEX_STRIDE + sizeof(IndexEntry)) + 1);
+    }
+}
+
+//Appends frames to a capture file through a writable mapping of the current segment, so recording a
+//frame is a memcpy plus a few header stores. Reopening an existing capture starts a new segment after
+//the existing ones. Timestamps are expected to be non-decreasing. One writer per file; not thread-safe.
+class CaptureWriter {
+public:
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 1 << 20;
+
+private:
+    int fd = -1;
+    size_t segmentSize = DEFAULT_SEGMENT_SIZE;
+    uint8_t *segment = nullptr;
+    void *mapping = nullptr; //segment minus the distance to the page boundary below it
+    size_t mappingSize = 0;
+    uint32_t sequence = 0;
+    off_t fileSize = 0;
+    uint32_t nextIndexOffset = 0;
+    uint64_t records = 0;
+
+    CaptureFormat::SegmentHeader &header() const {
+        return *reinterpret_cast<CaptureFormat::SegmentHeader *>(segment);
+    }
+
+    void unmapSegment() {
+        if (segment) {
+            munmap(mapping, mappingSize);
+            segment = nullptr;
+            mapping = nullptr;
+        }
+    }
+
+    bool openSegment() {
+        unmapSegment();
+        if (ftruncate(fd, fileSize + static_cast<off_t>(segmentSize)) != 0) {
+            LOG(LogLevel::ERROR, "Capture file could not be extended");
+            return false;
+        }
+        //Segments are only SEGMENT_ALIGNMENT-aligned, so on larger pages the mapping starts below the segment
+        const auto lead = static_cast<size_t>(fileSize % static_cast<off_t>(CaptureFormat::pageSize()));
+        mappingSize = segmentSize + lead;
+        mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, fileSize - static_cast<off_t>(lead));
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            LOG(LogLevel::ERROR, "Capture segment could not be mapped");
+            return false;
+        }
+        segment = static_cast<uint8_t *>(mapping) + lead;
+        fileSize += static_cast<off_t>(segmentSize);
+
+        const uint32_t capacity = CaptureFormat::indexCapacity(segmentSize);
+        CaptureFormat::SegmentHeader &h = header();
+        h.magic = CaptureFormat::SEGMENT_MAGIC;
+        h.version = CaptureFormat::VERSION;
+        h.headerSize = sizeof(CaptureFormat::SegmentHeader);
+        h.segmentSize = static_cast<uint32_t>(segmentSize);
+        h.sequence = sequence++;
+        h.indexCapacity = capacity;
+        h.dataOffset = static_cast<uint32_t>(sizeof(CaptureFormat::SegmentHeader) +
+                                             capacity * sizeof(CaptureFormat::IndexEntry));
+        nextIndexOffset = 0;
+        return true;
+    }
+
+public:
+    CaptureWriter() = default;
+
+    CaptureWriter(const CaptureWriter &) = delete;
+    CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+    ~CaptureWriter() {
+        close();
+    }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    //segmentSize is rounded up to a multiple of SEGMENT_ALIGNMENT
+    bool open(const char *path, const size_t requestedSegmentSize = DEFAULT_SEGMENT_SIZE) {
+        close();
+        segmentSize = std::max(requestedSegmentSize, 2 * CaptureFormat::SEGMENT_ALIGNMENT);
+        segmentSize = (segmentSize + CaptureFormat::SEGMENT_ALIGNMENT - 1) & ~(CaptureFormat::SEGMENT_ALIGNMENT - 1);
+        if (segmentSize > UINT32_MAX) {
+            LOG(LogLevel::ERROR, "Capture segment size too large");
+            return false;
+        }
+
+        fd = ::open(path, O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            LOG(LogLevel::ERROR, "Capture file could not be opened");
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size % CaptureFormat::SEGMENT_ALIGNMENT != 0) {
+            LOG(LogLevel::ERROR, "Existing capture file is not segment aligned");
+            close();
+            return false;
+        }
+        fileSize = st.st_size;
+        sequence = 0;
+        if (fileSize > 0) {
+            //Continue the sequence numbering from the last existing segment
+            CaptureFormat::SegmentHeader last{};
+            off_t offset = 0;
+            while (offset < fileSize &&
+                   pread(fd, &last, sizeof(last), offset) == static_cast<ssize_t>(sizeof(last)) &&
+                   last.magic == CaptureFormat::SEGMENT_MAGIC && last.segmentSize > 0) {
+                sequence = last.sequence + 1;
+                offset += last.segmentSize;
+            }
+        }
+        records = 0;
+        return openSegment();
+    }
+
+    bool appendAt(const uint64_t timestampNs, const uint16_t linkId, const uint8_t *frame, const size_t size) {
+        if (!segment) return false;
+
+        const size_t length = CaptureFormat::recordSize(size);
+        CaptureFormat::SegmentHeader *h = &header();
+        if (size > UINT16_MAX || h->dataOffset + length > segmentSize) {
+            LOG(LogLevel::ERROR, "Capture record larger than a segment");
+            return false;
+        }
+        if (h->dataOffset + h->dataBytes + length > segmentSize) {
+            if (!openSegment()) return false;
+            h = &header();
+        }
+
+        //Record first, then the header fields that make it visible
+        uint8_t *record = &segment[h->dataOffset + h->dataBytes];
+        CaptureFormat::RecordHeader rh{timestampNs, linkId, static_cast<uint16_t>(size), 0};
+        memcpy(record, &rh, sizeof(rh));
+        memcpy(&record[sizeof(rh)], frame, size);
+
+        if (h->dataBytes >= nextIndexOffset && h->indexCount < h->indexCapacity) {
+            CaptureFormat::IndexEntry entry{timestampNs, h->dataBytes, h->recordCount};
+            memcpy(&segment[sizeof(CaptureFormat::SegmentHeader) + h->indexCount * sizeof(entry)], &entry, sizeof(entry));
+            h->indexCount++;
+            nextIndexOffset = h->dataBytes + CaptureFormat::INDEX_STRIDE;
+        }
+        if (h->recordCount == 0) h->firstTimestampNs = timestampNs;
+        h->lastTimestampNs = timestampNs;
+        h->dataBytes += static_cast<uint32_t>(length);
+        h->recordCount++;
+        records++;
+        return true;
+    }
+
+    bool append(const uint16_t linkId, const uint8_t *frame, const size_t size) {
+        return appendAt(nowNs(), linkId, frame, size);
+    }
+
+    //Forces written records out to the file (they already survive a process crash once appended)
+    bool sync() const {
+        return segment && msync(mapping, mappingSize, MS_SYNC) == 0;
+    }
+
+    void close() {
+        unmapSegment();
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    bool isOpen() const { return fd >= 0; }
+    uint64_t recordsWritten() const { return records; }
+};
+
+//Drop-in FrameHandler that records each frame before passing it on, so a capture can be spliced
+//into a FrameStreamDecoder without touching the handlers themselves
+struct CaptureTap {
+    CaptureWriter *writer;
+    uint16_t linkId;
+    FrameHandler next;
+    void *nextContext;
+
+    static void handler(void *context, const uint8_t *frame, const size_t frameSize) {
+        const auto *tap = static_cast<const CaptureTap *>(context);
+        tap->writer->append(tap->linkId, frame, frameSize);
+        if (tap->next) tap->next(tap->nextContext, frame, frameSize);
+    }
+};
+
+struct CaptureRecord {
+    uint64_t timestampNs;
+    uint16_t linkId;
+    uint16_t size;
+    const uint8_t *frame; //points into the mapping; valid until the reader is closed
+};
+
+//Maps a whole capture read-only and walks it in place. Records hand out pointers straight into the
+//mapping, so frames can go to FrameView, FrameCodec or BinaryProtocol without a copy.
+class CaptureReader {
+private:
+    int fd = -1;
+    const uint8_t *base = nullptr;
+    size_t mappedSize = 0;
+    std::vector<const CaptureFormat::SegmentHeader *> segments; //non-empty segments only
+    size_t segmentIndex = 0;
+    uint32_t offset = 0;
+    uint64_t totalRecords = 0;
+
+    static bool segmentValid(const CaptureFormat::SegmentHeader &h, const size_t remaining) {
+        return h.magic == CaptureFormat::SEGMENT_MAGIC && h.version == CaptureFormat::VERSION &&
+               h.headerSize == sizeof(CaptureFormat::SegmentHeader) &&
+               h.segmentSize >= 2 * CaptureFormat::SEGMENT_ALIGNMENT && h.segmentSize % CaptureFormat::SEGMENT_ALIGNMENT == 0 &&
+               h.segmentSize <= remaining && h.indexCount <= h.indexCapacity &&
+               h.dataOffset >= sizeof(CaptureFormat::SegmentHeader) + h.indexCapacity * sizeof(CaptureFormat::IndexEntry) &&
+               static_cast<uint64_t>(h.dataOffset) + h.dataBytes <= h.segmentSize;
+    }
+
+    const uint8_t *segmentBase(const size_t index) const {
+        return reinterpret_cast<const uint8_t *>(segments[index]);
+    }
+
+    //Record at offset in segment index, or nullptr if it is past the end or damaged
+    const CaptureFormat::RecordHeader *recordAt(const size_t index, const uint32_t at) const {
+        const CaptureFormat::SegmentHeader &h = *segments[index];
+        if (static_cast<uint64_t>(at) + sizeof(CaptureFormat::RecordHeader) > h.dataBytes) return nullptr;
+        const auto *record = reinterpret_cast<const CaptureFormat::RecordHeader *>(&segmentBase(index)[h.dataOffset + at]);
+        if (at + CaptureFormat::recordSize(record->length) > h.dataBytes) return nullptr;
+        return record;
+    }
+
+public:
+    CaptureReader() = default;
+
+    CaptureReader(const CaptureReader &) = delete;
+    CaptureReader &operator=(const CaptureReader &) = delete;
+
+    ~CaptureReader() {
+        close();
+    }
+
+    bool open(const char *path) {
+        close();
+        fd = ::open(path, O_RDONLY);
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+            LOG(LogLevel::ERROR, "Capture file could not be opened");
+            close();
+            return false;
+        }
+        mappedSize = static_cast<size_t>(st.st_size);
+        void *mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            LOG(LogLevel::ERROR, "Capture file could not be mapped");
+            mappedSize = 0;
+            close();
+            return false;
+        }
+        base = static_cast<const uint8_t *>(mapping);
+        madvise(mapping, mappedSize, MADV_SEQUENTIAL);
+
+        size_t position = 0;
+        while (position + sizeof(CaptureFormat::SegmentHeader) <= mappedSize) {
+            const auto *h = reinterpret_cast<const CaptureFormat::SegmentHeader *>(&base[position]);
+            if (!segmentValid(*h, mappedSize - position)) {
+                LOG(LogLevel::WARNING, "Capture file has a damaged segment; ignoring the rest");
+                break;
+            }
+            if (h->recordCount > 0) {
+                segments.push_back(h);
+                totalRecords += h->recordCount;
+            }
+            position += h->segmentSize;
+        }
+        rewind();
+        return true;
+    }
+
+    void close() {
+        if (base) {
+            munmap(const_cast<uint8_t *>(base), mappedSize);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+        segments.clear();
+        mappedSize = 0;
+        totalRecords = 0;
+    }
+
+    void rewind() {
+        segmentIndex = 0;
+        offset = 0;
+    }
+
+    bool next(CaptureRecord &out) {
+        while (segmentIndex < segments.size()) {
+            if (const CaptureFormat::RecordHeader *record = recordAt(segmentIndex, offset)) {
+                out.timestampNs = record->timestampNs;
+                out.linkId = record->linkId;
+                out.size = record->length;
+                out.frame = reinterpret_cast<const uint8_t *>(record) + sizeof(CaptureFormat::RecordHeader);
+                offset += static_cast<uint32_t>(CaptureFormat::recordSize(record->length));
+                return true;
+            }
+            segmentIndex++;
+            offset = 0;
+        }
+        return false;
+    }
+
+    //Positions the cursor at the first record with timestampNs >= t; false if there is none
+    bool seek(const uint64_t timestampNs) {
+        const auto segment = std::partition_point(segments.begin(), segments.end(),
+                                                  [timestampNs](const CaptureFormat::SegmentHeader *h) {
+                                                      return h->lastTimestampNs < timestampNs;
+                                                  });
+        segmentIndex = static_cast<size_t>(segment - segments.begin());
+        offset = 0;
+        if (segmentIndex == segments.size()) return false;
+
+        const CaptureFormat::SegmentHeader &h = *segments[segmentIndex];
+        const auto *index = reinterpret_cast<const CaptureFormat::IndexEntry *>(
+            segmentBase(segmentIndex) + sizeof(CaptureFormat::SegmentHeader));
+        const CaptureFormat::IndexEntry *entry = std::partition_point(index, index + h.indexCount,
+                                                                      [timestampNs](const CaptureFormat::IndexEntry &e) {
+                                                                          return e.timestampNs < timestampNs;
+                                                                      });
+        if (entry != index) offset = (entry - 1)->offset;
+
+        while (const CaptureFormat::RecordHeader *record = recordAt(segmentIndex, offset)) {
+            if (record->timestampNs >= timestampNs) return true;
+            offset += static_cast<uint32_t>(CaptureFormat::recordSize(record->length));
+        }
+        return false;
+    }
+
+    //Positions the cursor at the first record of segment index (of segmentCount())
+    bool seekSegment(const size_t index) {
+        if (index >= segments.size()) return false;
+        segmentIndex = index;
+        offset = 0;
+        return true;
+    }
+
+    //Segment of the record next() returned last, or of the cursor after a seek
+    size_t segment() const { return segmentIndex; }
+
+    //Calls fn(const CaptureRecord&) for every remaining record; returns the number visited
+    template<typename Fn>
+    size_t forEach(Fn &&fn) {
+        CaptureRecord record{};
+        size_t visited = 0;
+        while (next(record)) {
+            fn(record);
+            visited++;
+        }
+        return visited;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    size_t segmentCount() const { return segments.size(); }
+    uint64_t recordCount() const { return totalRecords; }
+};
+
+#endif //SMARTDRIVE_CAPTUREFILE_H
@@ -0,0 +1,441 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_COMMANDCLIENT_H
+#define SMARTDRIVE_COMMANDCLIENT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../types/ProtocolTypes.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/Logger.h"
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#define SMARTDRIVE_HAS_COROUTINES 1
+#endif
+
+//TRANSACTION frames carry acknowledged commands. Every payload starts with
+//  kind(1) sequence(2)
+//A REQUEST follows with a Command, a RESPONSE with status(1) and up to MAX_RESULT_SIZE result bytes.
+//The device answers each REQUEST with a RESPONSE echoing its sequence; when it sees a sequence it
+//has already answered (a retransmission) it should repeat that response rather than run the command again.
+enum class CommandStatus : uint8_t {
+    OK = 0x00,
+    REJECTED = 0x01,
+    BUSY = 0x02,
+    //Produced locally, never sent by a device
+    TIMEOUT = 0xFE,
+    QUEUE_FULL = 0xFF
+};
+
+namespace Transaction {
+    enum class Kind : uint8_t {
+        REQUEST = 0,
+        RESPONSE = 1
+    };
+
+    constexpr size_t HEADER_SIZE = 3;
+    constexpr size_t REQUEST_SIZE = HEADER_SIZE + sizeof(Command);
+    constexpr size_t MAX_RESULT_SIZE = ProtocolConstants::MAX_PAYLOAD_SIZE - HEADER_SIZE - 1;
+
+    inline size_t encodeRequest(const uint16_t sequence, const Command &command, uint8_t *out, const size_t capacity) {
+        uint8_t payload[REQUEST_SIZE];
+        payload[0] = static_cast<uint8_t>(Kind::REQUEST);
+        ByteOrder::writeUint16LE(&payload[1], sequence);
+        memcpy(&payload[HEADER_SIZE], &command, sizeof(Command));
+        return FrameCodec::encodeFrame(ProtocolConstants::FrameType::TRANSACTION, payload, sizeof(payload), out, capacity);
+    }
+
+    inline size_t encodeResponse(const uint16_t sequence, const CommandStatus status, const uint8_t *result,
+                                 const size_t resultSize, uint8_t *out, const size_t capacity) {
+        if (resultSize > MAX_RESULT_SIZE) {
+            LOG(LogLevel::ERROR, "Command result exceeds max size");
+            return 0;
+        }
+        uint8_t payload[ProtocolConstants::MAX_PAYLOAD_SIZE];
+        payload[0] = static_cast<uint8_t>(Kind::RESPONSE);
+        ByteOrder::writeUint16LE(&payload[1], sequence);
+        payload[HEADER_SIZE] = static_cast<uint8_t>(status);
+        if (resultSize > 0) memcpy(&payload[HEADER_SIZE + 1], result, resultSize);
+        return FrameCodec::encodeFrame(ProtocolConstants::FrameType::TRANSACTION, payload,
+                                       HEADER_SIZE + 1 + resultSize, out, capacity);
+    }
+
+    //Fields of a validated TRANSACTION frame; pointers reference the frame
+    struct Message {
+        Kind kind = Kind::REQUEST;
+        uint16_t sequence = 0;
+        Command command{}; //REQUEST
+        CommandStatus status = CommandStatus::OK; //RESPONSE
+        const uint8_t *result = nullptr;
+        size_t resultSize = 0;
+    };
+
+    inline FrameStatus decode(const uint8_t *frame, const size_t size, Message &out) {
+        FrameStatus status = FrameView::validate(frame, size);
+        if (status == FrameStatus::OK &&
+            ProtocolConstants::decodeType(frame[0]) != ProtocolConstants::FrameType::TRANSACTION) {
+            status = FrameStatus::TYPE_MISMATCH;
+        }
+        const uint8_t *payload = &frame[ProtocolConstants::HEADER_SIZE];
+        const size_t length = status == FrameStatus::OK ? frame[1] : 0;
+        if (status == FrameStatus::OK) {
+            const bool request = length == REQUEST_SIZE && payload[0] == static_cast<uint8_t>(Kind::REQUEST);
+            const bool response = length > HEADER_SIZE && payload[0] == static_cast<uint8_t>(Kind::RESPONSE);
+            if (!request && !response) status = FrameStatus::MALFORMED_PAYLOAD;
+        }
+        if (status != FrameStatus::OK) {
+            ProtocolMetrics::frameRejected(status);
+            LOG_FRAME_STATUS(status, frame, size);
+            return status;
+        }
+        ProtocolMetrics::frameDecoded(ProtocolConstants::FrameType::TRANSACTION, size);
+
+        out.kind = static_cast<Kind>(payload[0]);
+        out.sequence = ByteOrder::readUint16LE(&payload[1]);
+        if (out.kind == Kind::REQUEST) {
+            memcpy(&out.command, &payload[HEADER_SIZE], sizeof(Command));
+        } else {
+            out.status = static_cast<CommandStatus>(payload[HEADER_SIZE]);
+            out.result = &payload[HEADER_SIZE + 1];
+            out.resultSize = length - HEADER_SIZE - 1;
+        }
+        return FrameStatus::OK;
+    }
+}
+
+//Hashed timer wheel over a fixed set of Capacity timer ids. schedule() and cancel() are O(1);
+//advance() visits only the buckets for the ticks that elapsed (at most one revolution).
+template<size_t Capacity, size_t Slots = 256>
+class TimerWheel {
+    static constexpr uint16_t NONE = 0xFFFF;
+    static_assert(Capacity < NONE, "TimerWheel ids must fit in 16 bits");
+
+    struct Node {
+        uint64_t tick = 0;
+        uint16_t next = NONE;
+        uint16_t prev = NONE;
+        bool armed = false;
+    };
+
+    Node nodes[Capacity];
+    uint16_t buckets[Slots];
+    uint64_t tickNs;
+    uint64_t currentTick = 0;
+
+    void unlink(const uint16_t id) {
+        Node &node = nodes[id];
+        if (node.prev != NONE) nodes[node.prev].next = node.next;
+        else buckets[node.tick % Slots] = node.next;
+        if (node.next != NONE) nodes[node.next].prev = node.prev;
+        node.armed = false;
+    }
+
+public:
+    explicit TimerWheel(const uint64_t tickNs) : tickNs(tickNs ? tickNs : 1) {
+        for (uint16_t &bucket : buckets) bucket = NONE;
+    }
+
+    void schedule(const size_t id, const uint64_t deadlineNs) {
+        const auto index = static_cast<uint16_t>(id);
+        if (nodes[index].armed) unlink(index);
+        uint64_t tick = (deadlineNs + tickNs - 1) / tickNs;
+        if (tick <= currentTick) tick = currentTick + 1;
+        Node &node = nodes[index];
+        node.tick = tick;
+        node.prev = NONE;
+        node.next = buckets[tick % Slots];
+        if (node.next != NONE) nodes[node.next].prev = index;
+        buckets[tick % Slots] = index;
+        node.armed = true;
+    }
+
+    void cancel(const size_t id) {
+        if (nodes[id].armed) unlink(static_cast<uint16_t>(id));
+    }
+
+    bool armed(const size_t id) const { return nodes[id].armed; }
+
+    //Disarms every timer due by nowNs and writes its id to expired (room for Capacity); returns the count
+    size_t advance(const uint64_t nowNs, uint16_t *expired) {
+        const uint64_t target = nowNs / tickNs;
+        if (target <= currentTick) return 0;
+        const uint64_t first = target - currentTick > Slots ? target - Slots + 1 : currentTick + 1;
+        size_t count = 0;
+        for (uint64_t tick = first; tick <= target; ++tick) {
+            uint16_t id = buckets[tick % Slots];
+            while (id != NONE) {
+                const uint16_t next = nodes[id].next;
+                if (nodes[id].tick <= target) {
+                    unlink(id);
+                    expired[count++] = id;
+                }
+                id = next;
+            }
+        }
+        currentTick = target;
+        return count;
+    }
+};
+
+//Called once per command with the device's response, or with TIMEOUT after the last retransmission;
+//result is only valid during the call
+using CommandCallback = void (*)(void *context, uint16_t sequence, CommandStatus status,
+                                 const uint8_t *result, size_t resultSize);
+
+//Writes one encoded frame to the link; returning false counts as a lost frame (the timer retransmits it)
+using FrameSender = bool (*)(void *context, const uint8_t *frame, size_t frameSize);
+
+//Pipelined, acknowledged commands over TRANSACTION frames. Up to Window requests are outstanding at
+//once; further submissions wait in a backlog and go out as responses free window slots, so a burst
+//of commands costs one round trip per window rather than per command. Request sequence s lives in
+//slot s % Window, which is why Window must divide 65536. A request unanswered after the timeout is
+//retransmitted with the same sequence, doubling the timeout each time, up to maxRetries.
+//Not thread-safe: submit, handleFrame and poll belong to the link's thread.
+template<size_t Window = 32>
+class CommandClient {
+    static_assert(Window > 0 && Window <= 32768 && (Window & (Window - 1)) == 0,
+                  "Window must be a power of two no larger than 32768");
+
+public:
+    struct Stats {
+        uint64_t submitted = 0;
+        uint64_t sent = 0;
+        uint64_t sendFailures = 0; //frames the sender refused; left to the retransmit timer
+        uint64_t retransmits = 0;
+        uint64_t completed = 0;
+        uint64_t timeouts = 0;
+        uint64_t stale = 0; //responses with no outstanding request (late or duplicate)
+        uint64_t refused = 0; //backlog full
+    };
+
+    struct Options {
+        uint64_t timeoutNs = 20000000;
+        uint8_t maxRetries = 3;
+        size_t maxBacklog = 1024;
+        uint64_t tickNs = 1000000;
+    };
+
+private:
+    struct Request {
+        bool active = false;
+        uint16_t sequence = 0;
+        uint8_t retries = 0;
+        uint64_t timeoutNs = 0;
+        Command command{};
+        CommandCallback callback = nullptr;
+        void *context = nullptr;
+    };
+
+    struct Queued {
+        Command command;
+        CommandCallback callback;
+        void *context;
+    };
+
+    FrameSender sender;
+    void *senderContext;
+    Options options;
+    Request requests[Window];
+    TimerWheel<Window> timers;
+    std::deque<Queued> backlog;
+    uint16_t nextSequence = 0;
+    size_t outstanding = 0;
+    Stats statistics;
+
+    void transmit(Request &request, const uint64_t nowNs) {
+        uint8_t frame[ProtocolConstants::MAX_FRAME_SIZE];
+        const size_t size = Transaction::encodeRequest(request.sequence, request.command, frame, sizeof(frame));
+        if (sender(senderContext, frame, size)) {
+            statistics.sent++;
+        } else {
+            statistics.sendFailures++;
+            LOG(LogLevel::WARNING, "Command frame not sent; will retransmit");
+        }
+        timers.schedule(request.sequence % Window, nowNs + request.timeoutNs);
+    }
+
+    //Starts queued commands while the next sequence's slot is free
+    void pump(const uint64_t nowNs) {
+        while (!backlog.empty() && !requests[nextSequence % Window].active) {
+            const Queued queued = backlog.front();
+            backlog.pop_front();
+            Request &request = requests[nextSequence % Window];
+            request.active = true;
+            request.sequence = nextSequence++;
+            request.retries = 0;
+            request.timeoutNs = options.timeoutNs;
+            request.command = queued.command;
+            request.callback = queued.callback;
+            request.context = queued.context;
+            outstanding++;
+            transmit(request, nowNs);
+        }
+    }
+
+    //Frees the slot before calling back, so the callback may submit again
+    void finish(Request &request, const CommandStatus status, const uint8_t *result, const size_t resultSize,
+                const uint64_t nowNs) {
+        const CommandCallback callback = request.callback;
+        void *context = request.context;
+        const uint16_t sequence = request.sequence;
+        timers.cancel(sequence % Window);
+        request.active = false;
+        outstanding--;
+        if (callback) callback(context, sequence, status, result, resultSize);
+        pump(nowNs);
+    }
+
+public:
+    CommandClient(const FrameSender sender, void *senderContext, const Options &options = Options())
+        : sender(sender), senderContext(senderContext), options(options), timers(options.tickNs) {
+    }
+
+    CommandClient(const CommandClient &) = delete;
+    CommandClient &operator=(const CommandClient &) = delete;
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    //Queues command; callback runs later from handleFrame() or poll(). Returns false if the backlog is full.
+    bool submit(const Command &command, const CommandCallback callback, void *context, const uint64_t nowNs) {
+        if (backlog.size() >= options.maxBacklog) {
+            statistics.refused++;
+            LOG(LogLevel::WARNING, "Command backlog full");
+            return false;
+        }
+        statistics.submitted++;
+        backlog.push_back({command, callback, context});
+        pump(nowNs);
+        return true;
+    }
+
+    bool submit(const Command &command, const CommandCallback callback, void *context = nullptr) {
+        return submit(command, callback, context, nowNs());
+    }
+
+    FrameStatus handleFrame(const uint8_t *frame, const size_t size, const uint64_t nowNs) {
+        Transaction::Message message;
+        const FrameStatus status = Transaction::decode(frame, size, message);
+        if (status != FrameStatus::OK) return status;
+        if (message.kind != Transaction::Kind::RESPONSE) return FrameStatus::OK;
+
+        Request &request = requests[message.sequence % Window];
+        if (!request.active || request.sequence != message.sequence) {
+            statistics.stale++;
+            return FrameStatus::OK;
+        }
+        statistics.completed++;
+        finish(request, message.status, message.result, message.resultSize, nowNs);
+        return FrameStatus::OK;
+    }
+
+    FrameStatus handleFrame(const uint8_t *frame, const size_t size) {
+        return handleFrame(frame, size, nowNs());
+    }
+
+    //FrameHandler adapter for FrameStreamDecoder; context is the client
+    static void frameHandler(void *context, const uint8_t *frame, const size_t size) {
+        static_cast<CommandClient *>(context)->handleFrame(frame, size);
+    }
+
+    //Retransmits or times out requests whose timers have expired; call at least once per tick
+    void poll(const uint64_t nowNs) {
+        uint16_t expired[Window];
+        const size_t count = timers.advance(nowNs, expired);
+        for (size_t i = 0; i < count; ++i) {
+            Request &request = requests[expired[i]];
+            if (!request.active) continue;
+            if (request.retries < options.maxRetries) {
+                request.retries++;
+                request.timeoutNs *= 2;
+                statistics.retransmits++;
+                transmit(request, nowNs);
+            } else {
+                statistics.timeouts++;
+                finish(request, CommandStatus::TIMEOUT, nullptr, 0, nowNs);
+            }
+        }
+    }
+
+    void poll() { poll(nowNs()); }
+
+    size_t inFlight() const { return outstanding; }
+    size_t queued() const { return backlog.size(); }
+    const Stats &stats() const { return statistics; }
+
+#ifdef SMARTDRIVE_HAS_COROUTINES
+    struct Result {
+        uint16_t sequence = 0;
+        CommandStatus status = CommandStatus::OK;
+        size_t size = 0;
+        uint8_t data[Transaction::MAX_RESULT_SIZE];
+    };
+
+    //co_await client.request(command) suspends until the response (or TIMEOUT) and yields a Result.
+    //The coroutine resumes inside handleFrame() or poll().
+    class Awaitable {
+        CommandClient &client;
+        Command command;
+        uint64_t submitNs;
+        Result result;
+        std::coroutine_handle<> waiting;
+
+        static void resume(void *context, const uint16_t sequence, const CommandStatus status,
+                           const uint8_t *data, const size_t size) {
+            auto *self = static_cast<Awaitable *>(context);
+            self->result.sequence = sequence;
+            self->result.status = status;
+            self->result.size = size;
+            if (size > 0) memcpy(self->result.data, data, size);
+            self->waiting.resume();
+        }
+
+    public:
+        Awaitable(CommandClient &client, const Command &command, const uint64_t submitNs)
+            : client(client), command(command), submitNs(submitNs) {
+        }
+
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(const std::coroutine_handle<> handle) {
+            waiting = handle;
+            if (client.submit(command, resume, this, submitNs)) return true;
+            result.status = CommandStatus::QUEUE_FULL;
+            return false;
+        }
+
+        Result await_resume() const { return result; }
+    };
+
+    Awaitable request(const Command &command, const uint64_t nowNs) { return Awaitable(*this, command, nowNs); }
+    Awaitable request(const Command &command) { return Awaitable(*this, command, nowNs()); }
+#endif
+};
+
+#ifdef SMARTDRIVE_HAS_COROUTINES
+//Eager, fire-and-forget coroutine type for callers without a task library of their own
+struct CommandTask {
+    struct promise_type {
+        CommandTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+#endif
+
+#endif //SMARTDRIVE_COMMANDCLIENT_H
@@ -0,0 +1,257 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_COMPACTCODEC_H
+#define SMARTDRIVE_COMPACTCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../types/ProtocolTypes.h"
+#include "../types/RobotData.h"
+#include "../types/ValueSource.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/Logger.h"
+
+//Variable-length wire form for ValueSource, SettingsData and TelemetryData frames. The frame type
+//is unchanged; the payload's ValueSource part becomes
+//  tag(1) = 0x80 | ValueType, then INT32/FLOAT 4 bytes, UINT16 2 bytes, STRING len(1) + len chars, EMPTY nothing
+//followed by the same trailing fields as the fixed layout (settingsID, or sourceID + timestamp).
+//In the fixed layout the first payload byte is the low byte of ValueType (0-4), so receivers tell
+//the two apart from that byte alone and can always accept both.
+namespace CompactCodec {
+    constexpr uint8_t COMPACT_TAG = 0x80;
+    constexpr size_t MAX_STRING_LENGTH = 15;
+    constexpr size_t MAX_VALUE_SIZE = 1 + 1 + MAX_STRING_LENGTH;
+
+    //Fields that follow the value, per payload type
+    template<typename T>
+    struct Trailer;
+
+    template<>
+    struct Trailer<ValueSource> {
+        static constexpr size_t size = 0;
+        static void write(const ValueSource &, uint8_t *) {}
+        static void read(const uint8_t *, ValueSource &) {}
+    };
+
+    template<>
+    struct Trailer<SettingsData> {
+        static constexpr size_t size = 2;
+        static void write(const SettingsData &s, uint8_t *out) { ByteOrder::writeUint16LE(out, s.settingsID); }
+        static void read(const uint8_t *in, SettingsData &s) { s.settingsID = ByteOrder::readUint16LE(in); }
+    };
+
+    template<>
+    struct Trailer<TelemetryData> {
+        static constexpr size_t size = 6;
+
+        static void write(const TelemetryData &t, uint8_t *out) {
+            ByteOrder::writeUint16LE(out, t.sourceID);
+            ByteOrder::writeUint32LE(&out[2], t.timestamp);
+        }
+
+        static void read(const uint8_t *in, TelemetryData &t) {
+            t.sourceID = ByteOrder::readUint16LE(in);
+            t.timestamp = ByteOrder::readUint32LE(&in[2]);
+        }
+    };
+
+    inline bool isCompact(const uint8_t *payload, const size_t payloadSize) {
+        return payloadSize > 0 && (payload[0] & COMPACT_TAG) != 0;
+    }
+
+    //Returns bytes written to out (at most MAX_VALUE_SIZE)
+    inline size_t encodeValue(const ValueSource &value, uint8_t *out) {
+        const ValueType type = value.getType();
+        out[0] = static_cast<uint8_t>(COMPACT_TAG | static_cast<uint8_t>(type));
+        switch (type) {
+            case ValueType::INT32: {
+                const int32_t v = value.unpack<int32_t>();
+                memcpy(&out[1], &v, sizeof(v));
+                return 1 + sizeof(v);
+            }
+            case ValueType::UINT16: {
+                const uint16_t v = value.unpack<uint16_t>();
+                memcpy(&out[1], &v, sizeof(v));
+                return 1 + sizeof(v);
+            }
+            case ValueType::FLOAT: {
+                const float v = value.unpack<float>();
+                memcpy(&out[1], &v, sizeof(v));
+                return 1 + sizeof(v);
+            }
+            case ValueType::STRING: {
+                const size_t length = strnlen(value.unpackString(), MAX_STRING_LENGTH);
+                out[1] = static_cast<uint8_t>(length);
+                memcpy(&out[2], value.unpackString(), length);
+                return 2 + length;
+            }
+            default:
+                out[0] = COMPACT_TAG;
+                return 1;
+        }
+    }
+
+    //Returns bytes consumed, or 0 if the tag is unknown or the value is truncated
+    inline size_t decodeValue(const uint8_t *in, const size_t available, ValueSource &out) {
+        if (available == 0 || (in[0] & COMPACT_TAG) == 0) return 0;
+        switch (static_cast<ValueType>(in[0] & ~COMPACT_TAG)) {
+            case ValueType::EMPTY:
+                out.clear();
+                return 1;
+            case ValueType::INT32: {
+                if (available < 5) return 0;
+                int32_t v;
+                memcpy(&v, &in[1], sizeof(v));
+                out.clear();
+                out.pack<int32_t>(v);
+                return 5;
+            }
+            case ValueType::UINT16: {
+                if (available < 3) return 0;
+                uint16_t v;
+                memcpy(&v, &in[1], sizeof(v));
+                out.clear();
+                out.pack<uint16_t>(v);
+                return 3;
+            }
+            case ValueType::FLOAT: {
+                if (available < 5) return 0;
+                float v;
+                memcpy(&v, &in[1], sizeof(v));
+                out.clear();
+                out.pack<float>(v);
+                return 5;
+            }
+            case ValueType::STRING: {
+                if (available < 2 || in[1] > MAX_STRING_LENGTH || available < 2u + in[1]) return 0;
+                char text[MAX_STRING_LENGTH + 1] = {};
+                memcpy(text, &in[2], in[1]);
+                out.clear();
+                out.packString(text);
+                return 2 + in[1];
+            }
+            default:
+                return 0;
+        }
+    }
+
+    template<typename T>
+    inline size_t serialize(const T &value, uint8_t *out, const size_t capacity) {
+        uint8_t payload[MAX_VALUE_SIZE + Trailer<T>::size];
+        const size_t valueSize = encodeValue(value, payload);
+        Trailer<T>::write(value, &payload[valueSize]);
+        return FrameCodec::encodeFrame(FrameTraits<T>::type, payload, valueSize + Trailer<T>::size, out, capacity);
+    }
+
+    //Accepts either wire form of T
+    template<typename T>
+    inline FrameStatus deserialize(const uint8_t *data, const size_t size, T &out) {
+        if (size <= ProtocolConstants::HEADER_SIZE || !isCompact(&data[ProtocolConstants::HEADER_SIZE], data[1])) {
+            return FrameCodec::deserialize(data, size, out);
+        }
+
+        const ProtocolMetrics::LatencyTimer timer(ProtocolMetrics::Operation::DECODE);
+        FrameStatus status = FrameView::validate(data, size);
+        if (status == FrameStatus::OK && ProtocolConstants::decodeType(data[0]) != FrameTraits<T>::type) {
+            status = FrameStatus::TYPE_MISMATCH;
+        }
+        if (status == FrameStatus::OK) {
+            const uint8_t *payload = &data[ProtocolConstants::HEADER_SIZE];
+            const size_t payloadSize = data[1];
+            T decoded{};
+            const size_t valueSize = decodeValue(payload, payloadSize, decoded);
+            if (valueSize == 0 || valueSize + Trailer<T>::size != payloadSize) {
+                status = FrameStatus::MALFORMED_PAYLOAD;
+            } else {
+                Trailer<T>::read(&payload[valueSize], decoded);
+                out = decoded;
+                ProtocolMetrics::frameDecoded(FrameTraits<T>::type, size);
+            }
+        }
+        if (status != FrameStatus::OK) {
+            ProtocolMetrics::frameRejected(status);
+            LOG_FRAME_STATUS(status, data, size);
+        }
+        return status;
+    }
+}
+
+enum class WireEncoding : uint8_t {
+    FIXED = 0,
+    COMPACT = 1
+};
+
+//Per-link encoding choice. Each side sends capabilityFrame() when the link comes up and switches
+//to COMPACT only once the peer's own announcement arrives. A peer on the fixed layout drops the
+//announcement (its payload is not Command-sized) and never sends one, so the link stays FIXED.
+//Receiving always auto-detects, so there is no window in which either side misreads a frame while switching.
+class LinkCodec {
+private:
+    uint16_t localCapabilities;
+    uint16_t peerCapabilities = 0;
+    WireEncoding encoding = WireEncoding::FIXED;
+
+public:
+    explicit LinkCodec(const uint16_t capabilities = ProtocolConstants::CAPABILITY_COMPACT_VALUES)
+        : localCapabilities(capabilities) {
+    }
+
+    size_t capabilityFrame(uint8_t *out, const size_t capacity) const {
+        uint8_t payload[ProtocolConstants::CAPABILITY_PAYLOAD_SIZE];
+        ByteOrder::writeUint16LE(payload, ProtocolConstants::CAPABILITY_MAGIC);
+        ByteOrder::writeUint16LE(&payload[2], localCapabilities);
+        return FrameCodec::encodeFrame(ProtocolConstants::FrameType::COMMAND, payload, sizeof(payload), out, capacity);
+    }
+
+    static bool isCapabilityFrame(const uint8_t *frame, const size_t size) {
+        return FrameView::validate(frame, size) == FrameStatus::OK &&
+               ProtocolConstants::decodeType(frame[0]) == ProtocolConstants::FrameType::COMMAND &&
+               frame[1] == ProtocolConstants::CAPABILITY_PAYLOAD_SIZE &&
+               ByteOrder::readUint16LE(&frame[ProtocolConstants::HEADER_SIZE]) == ProtocolConstants::CAPABILITY_MAGIC;
+    }
+
+    //Returns true if frame was the peer's capability announcement and has been consumed
+    bool handleFrame(const uint8_t *frame, const size_t size) {
+        if (!isCapabilityFrame(frame, size)) return false;
+        peerCapabilities = ByteOrder::readUint16LE(&frame[ProtocolConstants::HEADER_SIZE + 2]);
+        encoding = (localCapabilities & peerCapabilities & ProtocolConstants::CAPABILITY_COMPACT_VALUES)
+                       ? WireEncoding::COMPACT
+                       : WireEncoding::FIXED;
+        return true;
+    }
+
+    //For links whose peer is known in advance and never negotiates
+    void setEncoding(const WireEncoding e) { encoding = e; }
+
+    WireEncoding txEncoding() const { return encoding; }
+    uint16_t peerCapabilityMask() const { return peerCapabilities; }
+
+    template<typename T>
+    size_t serialize(const T &value, uint8_t *out, const size_t capacity) const {
+        if constexpr (std::is_base_of_v<ValueSource, T>) {
+            if (encoding == WireEncoding::COMPACT) {
+                return CompactCodec::serialize(value, out, capacity);
+            }
+        }
+        return FrameCodec::serialize(value, out, capacity);
+    }
+
+    template<typename T>
+    FrameStatus deserialize(const uint8_t *data, const size_t size, T &out) const {
+        if constexpr (std::is_base_of_v<ValueSource, T>) {
+            return CompactCodec::deserialize(data, size, out);
+        } else {
+            return FrameCodec::deserialize(data, size, out);
+        }
+    }
+};
+
+#endif //SMARTDRIVE_COMPACTCODEC_H
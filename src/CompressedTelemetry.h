@@ -0,0 +1,281 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_COMPRESSEDTELEMETRY_H
+#define SMARTDRIVE_COMPRESSEDTELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../types/RobotData.h"
+#include "../utils/Logger.h"
+#include "../utils/Varint.h"
+
+//COMPRESSED_TELEMETRY payload: count(1) followed by count samples, all under the frame's one CRC.
+//Each sample is
+//  control(1)  bits 0-1 ValueType, bits 2-4 leading zero bytes, bits 5-6 trailing zero bytes (floats only)
+//  sourceID    zig-zag varint of the delta to the previous sample's sourceID
+//  timestamp   zig-zag varint of the delta-of-delta to the previous two samples
+//  value       INT32/UINT16: zig-zag varint of the delta to the last value of the same source and type
+//              FLOAT: the non-zero middle bytes of the XOR with that value
+//Deltas wrap modulo the field width, so every input round-trips exactly. STRING samples are not supported;
+//encode() sends them as plain TELEMETRY frames.
+namespace CompressedTelemetry {
+    constexpr size_t MAX_SAMPLE_SIZE = 1 + 3 + Varint::MAX_SIZE_32 + Varint::MAX_SIZE_32;
+    //A sample is at least three bytes (control, sourceID, timestamp)
+    constexpr size_t MAX_SAMPLES = (ProtocolConstants::MAX_PAYLOAD_SIZE - 1) / 3;
+
+    namespace detail {
+        //Encoder and decoder run the same predictor over the samples already in the frame
+        struct History {
+            uint16_t sourceIDs[MAX_SAMPLES];
+            ValueType types[MAX_SAMPLES];
+            uint32_t bits[MAX_SAMPLES];
+            size_t count = 0;
+            uint16_t lastSource = 0;
+            uint32_t lastTimestamp = 0;
+            uint32_t lastDelta = 0;
+
+            uint32_t predict(const uint16_t sourceID, const ValueType type) const {
+                for (size_t i = count; i-- > 0;) {
+                    if (sourceIDs[i] == sourceID && types[i] == type) return bits[i];
+                }
+                return 0;
+            }
+
+            void push(const uint16_t sourceID, const ValueType type, const uint32_t valueBits, const uint32_t timestamp) {
+                sourceIDs[count] = sourceID;
+                types[count] = type;
+                bits[count] = valueBits;
+                count++;
+                lastDelta = timestamp - lastTimestamp;
+                lastTimestamp = timestamp;
+                lastSource = sourceID;
+            }
+        };
+
+        inline uint32_t valueBits(const TelemetryData &telemetry) {
+            switch (telemetry.getType()) {
+                case ValueType::INT32: return static_cast<uint32_t>(telemetry.unpack<int32_t>());
+                case ValueType::UINT16: return telemetry.unpack<uint16_t>();
+                default: {
+                    const float value = telemetry.unpack<float>();
+                    uint32_t bits;
+                    memcpy(&bits, &value, sizeof(bits));
+                    return bits;
+                }
+            }
+        }
+    }
+
+    inline bool supports(const ValueType type) {
+        return type == ValueType::INT32 || type == ValueType::UINT16 || type == ValueType::FLOAT;
+    }
+
+    //Accumulates samples into one COMPRESSED_TELEMETRY payload. add() returns false once the next
+    //sample would not fit; flush() then emits the frame and starts a new one.
+    class Encoder {
+    private:
+        uint8_t payload[ProtocolConstants::MAX_PAYLOAD_SIZE];
+        size_t length = 1;
+        detail::History history;
+
+    public:
+        Encoder() { payload[0] = 0; }
+
+        bool add(const TelemetryData &telemetry) {
+            const ValueType type = telemetry.getType();
+            if (!supports(type)) {
+                LOG(LogLevel::ERROR, "Unsupported value type for compressed telemetry");
+                return false;
+            }
+            if (history.count == MAX_SAMPLES) {
+                return false;
+            }
+
+            uint8_t sample[MAX_SAMPLE_SIZE];
+            size_t size = 1;
+            uint8_t control = static_cast<uint8_t>(type);
+
+            const auto sourceDelta = static_cast<int16_t>(telemetry.sourceID - history.lastSource);
+            size += Varint::write(&sample[size], Varint::zigzagEncode(sourceDelta));
+
+            const uint32_t delta = telemetry.timestamp - history.lastTimestamp;
+            size += Varint::write(&sample[size], Varint::zigzagEncode(static_cast<int32_t>(delta - history.lastDelta)));
+
+            const uint32_t bits = detail::valueBits(telemetry);
+            const uint32_t previous = history.predict(telemetry.sourceID, type);
+            if (type == ValueType::FLOAT) {
+                const uint32_t x = bits ^ previous;
+                uint8_t leading = 4;
+                uint8_t trailing = 0;
+                if (x != 0) {
+                    leading = static_cast<uint8_t>(__builtin_clz(x) / 8);
+                    trailing = static_cast<uint8_t>(__builtin_ctz(x) / 8);
+                }
+                control |= static_cast<uint8_t>(leading << 2 | trailing << 5);
+                for (uint8_t b = trailing; b < 4 - leading; ++b) {
+                    sample[size++] = static_cast<uint8_t>(x >> (8 * b));
+                }
+            } else if (type == ValueType::INT32) {
+                size += Varint::write(&sample[size], Varint::zigzagEncode(static_cast<int32_t>(bits - previous)));
+            } else {
+                const auto valueDelta = static_cast<int16_t>(bits - previous);
+                size += Varint::write(&sample[size], Varint::zigzagEncode(valueDelta));
+            }
+            sample[0] = control;
+
+            if (length + size > ProtocolConstants::MAX_PAYLOAD_SIZE) {
+                return false;
+            }
+            memcpy(&payload[length], sample, size);
+            length += size;
+            history.push(telemetry.sourceID, type, bits, telemetry.timestamp);
+            payload[0] = static_cast<uint8_t>(history.count);
+            return true;
+        }
+
+        size_t sampleCount() const { return history.count; }
+        size_t payloadSize() const { return length; }
+
+        //Writes the frame and resets; returns 0 if nothing is pending or out is too small
+        size_t flush(uint8_t *out, const size_t capacity) {
+            if (history.count == 0) return 0;
+            const size_t written = FrameCodec::encodeFrame(ProtocolConstants::FrameType::COMPRESSED_TELEMETRY,
+                                                           payload, length, out, capacity);
+            if (written > 0) reset();
+            return written;
+        }
+
+        void reset() {
+            length = 1;
+            payload[0] = 0;
+            history = detail::History();
+        }
+    };
+
+    //Packs as many samples from the front of samples as fit into one frame.
+    //Returns bytes written; consumed is the number of samples the frame holds. A leading sample that
+    //cannot be compressed (STRING) is written as a plain TELEMETRY frame instead, so consumed only
+    //stays 0 when out is too small.
+    inline size_t encode(const TelemetryData *samples, const size_t count, uint8_t *out, const size_t capacity,
+                         size_t &consumed) {
+        consumed = 0;
+        if (count > 0 && !supports(samples[0].getType())) {
+            const size_t written = FrameCodec::serialize(samples[0], out, capacity);
+            consumed = written > 0 ? 1 : 0;
+            return written;
+        }
+        Encoder encoder;
+        while (consumed < count && supports(samples[consumed].getType()) && encoder.add(samples[consumed])) {
+            consumed++;
+        }
+        const size_t written = encoder.flush(out, capacity);
+        if (written == 0) consumed = 0;
+        return written;
+    }
+
+    //Validates one COMPRESSED_TELEMETRY frame and expands it into out. decodedCount is the number of
+    //samples decoded on success, the number the frame holds on BUFFER_TOO_SMALL, and 0 otherwise.
+    inline FrameStatus decode(const uint8_t *frame, const size_t size,
+                              TelemetryData *out, const size_t capacity, size_t &decodedCount) {
+        const ProtocolMetrics::LatencyTimer timer(ProtocolMetrics::Operation::DECODE);
+        decodedCount = 0;
+        FrameStatus status = FrameView::validate(frame, size);
+        if (status == FrameStatus::OK &&
+            ProtocolConstants::decodeType(frame[0]) != ProtocolConstants::FrameType::COMPRESSED_TELEMETRY) {
+            status = FrameStatus::TYPE_MISMATCH;
+        }
+        if (status != FrameStatus::OK) {
+            ProtocolMetrics::frameRejected(status);
+            LOG_FRAME_STATUS(status, frame, size);
+            return status;
+        }
+
+        const uint8_t *payload = &frame[ProtocolConstants::HEADER_SIZE];
+        const size_t length = frame[1];
+        if (length == 0 || payload[0] > MAX_SAMPLES) {
+            ProtocolMetrics::frameRejected(FrameStatus::MALFORMED_PAYLOAD);
+            LOG_FRAME_STATUS(FrameStatus::MALFORMED_PAYLOAD, frame, size);
+            return FrameStatus::MALFORMED_PAYLOAD;
+        }
+        if (payload[0] > capacity) {
+            decodedCount = payload[0];
+            return FrameStatus::BUFFER_TOO_SMALL;
+        }
+
+        const size_t count = payload[0];
+        detail::History history;
+        size_t offset = 1;
+        for (size_t i = 0; i < count; ++i) {
+            if (offset >= length) break;
+            const uint8_t control = payload[offset++];
+            const auto type = static_cast<ValueType>(control & 0x03);
+            if (type == ValueType::EMPTY) break;
+
+            uint32_t sourceDelta, deltaOfDelta;
+            size_t used = Varint::read(&payload[offset], length - offset, sourceDelta);
+            if (used == 0) break;
+            offset += used;
+            used = Varint::read(&payload[offset], length - offset, deltaOfDelta);
+            if (used == 0) break;
+            offset += used;
+
+            const auto sourceID = static_cast<uint16_t>(history.lastSource + Varint::zigzagDecode(sourceDelta));
+            const uint32_t timestamp = history.lastTimestamp + history.lastDelta +
+                                       static_cast<uint32_t>(Varint::zigzagDecode(deltaOfDelta));
+            const uint32_t previous = history.predict(sourceID, type);
+
+            TelemetryData &telemetry = out[i];
+            telemetry = TelemetryData(); //pack() writes only the value's own bytes
+            telemetry.sourceID = sourceID;
+            telemetry.timestamp = timestamp;
+            uint32_t bits;
+            if (type == ValueType::FLOAT) {
+                const uint8_t leading = control >> 2 & 0x07;
+                const uint8_t trailing = control >> 5 & 0x03;
+                if (leading > 4 || leading + trailing > 4 || (leading == 4 && trailing != 0) ||
+                    offset + (4 - leading - trailing) > length) {
+                    break;
+                }
+                uint32_t x = 0;
+                for (uint8_t b = trailing; b < 4 - leading; ++b) {
+                    x |= static_cast<uint32_t>(payload[offset++]) << (8 * b);
+                }
+                bits = previous ^ x;
+                float value;
+                memcpy(&value, &bits, sizeof(value));
+                telemetry.pack<float>(value);
+            } else {
+                uint32_t valueDelta;
+                used = Varint::read(&payload[offset], length - offset, valueDelta);
+                if (used == 0) break;
+                offset += used;
+                bits = previous + static_cast<uint32_t>(Varint::zigzagDecode(valueDelta));
+                if (type == ValueType::INT32) {
+                    telemetry.pack<int32_t>(static_cast<int32_t>(bits));
+                } else {
+                    bits &= 0xFFFF;
+                    telemetry.pack<uint16_t>(static_cast<uint16_t>(bits));
+                }
+            }
+            history.push(sourceID, type, bits, timestamp);
+        }
+
+        if (history.count != count || offset != length) {
+            ProtocolMetrics::frameRejected(FrameStatus::MALFORMED_PAYLOAD);
+            LOG_FRAME_STATUS(FrameStatus::MALFORMED_PAYLOAD, frame, size);
+            return FrameStatus::MALFORMED_PAYLOAD;
+        }
+        decodedCount = count;
+        ProtocolMetrics::frameDecoded(ProtocolConstants::FrameType::COMPRESSED_TELEMETRY, size);
+        return FrameStatus::OK;
+    }
+}
+
+#endif //SMARTDRIVE_COMPRESSEDTELEMETRY_H
@@ -0,0 +1,330 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_FRAGMENTATION_H
+#define SMARTDRIVE_FRAGMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/CRC16.h"
+#include "../utils/Logger.h"
+
+//Messages larger than MAX_PAYLOAD_SIZE travel as FRAGMENT frames. Every fragment payload starts with
+//  messageID(2) fragmentIndex(2) fragmentCount(2)
+//and fragment 0 then adds
+//  kind(1) totalLength(4) messageCRC(2)
+//before its data. The rest is message data: FIRST_DATA_SIZE bytes in fragment 0, DATA_SIZE bytes in
+//every other fragment, so a fragment's offset is known without fragment 0. Each fragment is an
+//ordinary frame with its own CRC; messageCRC (CRC16 over the whole message) catches fragments
+//from different messages mixed under one messageID.
+namespace Fragmentation {
+    constexpr size_t HEADER_SIZE = 6;
+    constexpr size_t FIRST_HEADER_SIZE = HEADER_SIZE + 7;
+    constexpr size_t DATA_SIZE = ProtocolConstants::MAX_PAYLOAD_SIZE - HEADER_SIZE;
+    constexpr size_t FIRST_DATA_SIZE = ProtocolConstants::MAX_PAYLOAD_SIZE - FIRST_HEADER_SIZE;
+    constexpr size_t MAX_FRAGMENTS = 0xFFFF;
+    constexpr size_t MAX_MESSAGE_SIZE = FIRST_DATA_SIZE + (MAX_FRAGMENTS - 1) * DATA_SIZE;
+
+    constexpr size_t fragmentCount(const size_t messageSize) {
+        return messageSize <= FIRST_DATA_SIZE ? 1 : 1 + (messageSize - FIRST_DATA_SIZE + DATA_SIZE - 1) / DATA_SIZE;
+    }
+
+    constexpr size_t offsetOf(const size_t index) {
+        return index == 0 ? 0 : FIRST_DATA_SIZE + (index - 1) * DATA_SIZE;
+    }
+
+    //Called once per complete, verified message; data is only valid during the call
+    using MessageHandler = void (*)(void *context, uint16_t messageID, uint8_t kind, const uint8_t *data, size_t size);
+
+    //Emits one message as FRAGMENT frames, one per next() call, so the caller can hand each to an
+    //OutboundScheduler (FRAGMENT is BULK by default) and let commands go out in between.
+    //data must stay valid until done().
+    class Fragmenter {
+    private:
+        const uint8_t *data;
+        size_t size;
+        uint16_t messageID;
+        uint8_t kind;
+        uint16_t count;
+        uint16_t crc;
+        size_t index = 0;
+
+    public:
+        Fragmenter(const uint16_t messageID, const uint8_t kind, const uint8_t *data, const size_t size)
+            : data(data), size(size), messageID(messageID), kind(kind),
+              count(static_cast<uint16_t>(size <= MAX_MESSAGE_SIZE ? fragmentCount(size) : 0)),
+              crc(CRC16::compute(data, size)) {
+            if (size > MAX_MESSAGE_SIZE) {
+                LOG(LogLevel::ERROR, "Message too large to fragment");
+            }
+        }
+
+        bool done() const { return index >= count; }
+        size_t totalFragments() const { return count; }
+
+        //Writes the next fragment frame; returns bytes written, 0 when done or out is too small
+        size_t next(uint8_t *out, const size_t capacity) {
+            if (done()) return 0;
+            uint8_t payload[ProtocolConstants::MAX_PAYLOAD_SIZE];
+            ByteOrder::writeUint16LE(payload, messageID);
+            ByteOrder::writeUint16LE(&payload[2], static_cast<uint16_t>(index));
+            ByteOrder::writeUint16LE(&payload[4], count);
+
+            size_t headerSize = HEADER_SIZE, chunk = DATA_SIZE;
+            if (index == 0) {
+                payload[6] = kind;
+                ByteOrder::writeUint32LE(&payload[7], static_cast<uint32_t>(size));
+                ByteOrder::writeUint16LE(&payload[11], crc);
+                headerSize = FIRST_HEADER_SIZE;
+                chunk = FIRST_DATA_SIZE;
+            }
+            const size_t offset = offsetOf(index);
+            if (chunk > size - offset) chunk = size - offset;
+            memcpy(&payload[headerSize], &data[offset], chunk);
+
+            const size_t written = FrameCodec::encodeFrame(ProtocolConstants::FrameType::FRAGMENT, payload,
+                                                           headerSize + chunk, out, capacity);
+            if (written > 0) index++;
+            return written;
+        }
+    };
+
+    //Rebuilds messages from FRAGMENT frames in any order, interleaved across up to Slots messages.
+    //All buffers are allocated once by the constructor; a message is dropped if it is idle for
+    //longer than the timeout, and the least recently active one is evicted when a new message
+    //finds every slot busy. The last few completed messages are remembered for the timeout as well,
+    //so a late duplicate of one is counted and dropped rather than opening (or evicting) a slot.
+    //A sender may reuse a messageID within the timeout only by sending fragment 0 first (as
+    //Fragmenter does) with a different length or message CRC; that fragment starts the new message.
+    //Other fragments of a recently completed (messageID, count) are taken for late duplicates.
+    template<size_t Slots = 4, size_t MaxMessageSize = 64 * 1024>
+    class Reassembler {
+        static_assert(MaxMessageSize <= MAX_MESSAGE_SIZE, "MaxMessageSize exceeds what FRAGMENT frames can carry");
+
+    public:
+        static constexpr size_t MAX_FRAGMENTS_PER_MESSAGE = fragmentCount(MaxMessageSize);
+
+        struct Stats {
+            uint64_t fragments = 0;
+            uint64_t duplicates = 0;
+            uint64_t lateDuplicates = 0; //fragments of a message that had already completed
+            uint64_t completed = 0;
+            uint64_t corrupt = 0; //length or message CRC mismatch
+            uint64_t tooLarge = 0;
+            uint64_t timedOut = 0;
+            uint64_t evicted = 0;
+        };
+
+        static constexpr size_t RECENT_COMPLETED = 8;
+
+    private:
+        struct Slot {
+            bool active = false;
+            uint8_t kind = 0;
+            uint16_t messageID = 0;
+            uint16_t count = 0;
+            uint16_t received = 0;
+            uint16_t crc = 0;
+            uint32_t totalLength = 0;
+            size_t bytes = 0;
+            uint64_t lastActivityNs = 0;
+            uint64_t seen[(MAX_FRAGMENTS_PER_MESSAGE + 63) / 64];
+            uint8_t buffer[MaxMessageSize];
+        };
+
+        struct Completed {
+            bool valid = false;
+            uint16_t messageID = 0;
+            uint16_t count = 0;
+            uint16_t crc = 0;
+            uint32_t totalLength = 0;
+            uint64_t completedNs = 0;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        Completed recent[RECENT_COMPLETED];
+        size_t recentNext = 0;
+        uint64_t timeoutNs;
+        MessageHandler handler = nullptr;
+        void *handlerContext = nullptr;
+        Stats statistics;
+
+        Completed *recentlyCompleted(const uint16_t messageID, const uint16_t count, const uint64_t nowNs) {
+            for (Completed &c : recent) {
+                if (c.valid && c.messageID == messageID && c.count == count && nowNs - c.completedNs <= timeoutNs) {
+                    return &c;
+                }
+            }
+            return nullptr;
+        }
+
+        //nullptr when the fragment belongs to a message that has just completed
+        Slot *slotFor(const uint16_t messageID, const uint16_t count, const uint16_t index, const uint8_t *payload,
+                      const uint64_t nowNs) {
+            Slot *idle = nullptr, *oldest = nullptr;
+            for (size_t i = 0; i < Slots; ++i) {
+                Slot &slot = slots[i];
+                if (slot.active && slot.messageID == messageID && slot.count == count) return &slot;
+                if (!slot.active) {
+                    if (!idle) idle = &slot;
+                } else if (!oldest || slot.lastActivityNs < oldest->lastActivityNs) {
+                    oldest = &slot;
+                }
+            }
+            if (Completed *done = recentlyCompleted(messageID, count, nowNs)) {
+                if (index != 0 || (done->totalLength == ByteOrder::readUint32LE(&payload[7]) &&
+                                   done->crc == ByteOrder::readUint16LE(&payload[11]))) {
+                    return nullptr;
+                }
+                done->valid = false; //fragment 0 of a new message reusing the ID
+            }
+            if (!idle) {
+                idle = oldest;
+                statistics.evicted++;
+                LOG(LogLevel::WARNING, "Reassembly slot evicted");
+            }
+            idle->active = true;
+            idle->messageID = messageID;
+            idle->count = count;
+            idle->received = 0;
+            idle->bytes = 0;
+            memset(idle->seen, 0, sizeof(idle->seen));
+            return idle;
+        }
+
+        void complete(Slot &slot, const uint64_t nowNs) {
+            slot.active = false;
+            recent[recentNext] = {true, slot.messageID, slot.count, slot.crc, slot.totalLength, nowNs};
+            recentNext = (recentNext + 1) % RECENT_COMPLETED;
+            if (slot.totalLength != slot.bytes || CRC16::compute(slot.buffer, slot.bytes) != slot.crc) {
+                statistics.corrupt++;
+                LOG(LogLevel::ERROR, "Reassembled message failed integrity check");
+                return;
+            }
+            statistics.completed++;
+            if (handler) handler(handlerContext, slot.messageID, slot.kind, slot.buffer, slot.bytes);
+        }
+
+    public:
+        explicit Reassembler(const uint64_t timeoutNs = 2000000000) : slots(new Slot[Slots]), timeoutNs(timeoutNs) {
+        }
+
+        static uint64_t nowNs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        void setHandler(const MessageHandler messageHandler, void *context = nullptr) {
+            handler = messageHandler;
+            handlerContext = context;
+        }
+
+        //Drops messages idle for longer than the timeout
+        void expire(const uint64_t nowNs) {
+            for (size_t i = 0; i < Slots; ++i) {
+                if (slots[i].active && nowNs - slots[i].lastActivityNs > timeoutNs) {
+                    slots[i].active = false;
+                    statistics.timedOut++;
+                }
+            }
+        }
+
+        FrameStatus handleFrame(const uint8_t *frame, const size_t size, const uint64_t nowNs) {
+            FrameStatus status = FrameView::validate(frame, size);
+            if (status == FrameStatus::OK &&
+                ProtocolConstants::decodeType(frame[0]) != ProtocolConstants::FrameType::FRAGMENT) {
+                status = FrameStatus::TYPE_MISMATCH;
+            }
+            const uint8_t *payload = &frame[ProtocolConstants::HEADER_SIZE];
+            const size_t length = status == FrameStatus::OK ? frame[1] : 0;
+            uint16_t messageID = 0, index = 0, count = 0;
+            if (status == FrameStatus::OK) {
+                messageID = ByteOrder::readUint16LE(payload);
+                index = ByteOrder::readUint16LE(&payload[2]);
+                count = ByteOrder::readUint16LE(&payload[4]);
+                const size_t headerSize = index == 0 ? FIRST_HEADER_SIZE : HEADER_SIZE;
+                if (length < headerSize || count == 0 || index >= count ||
+                    (index + 1u < count && length != ProtocolConstants::MAX_PAYLOAD_SIZE)) {
+                    status = FrameStatus::MALFORMED_PAYLOAD;
+                }
+            }
+            if (status != FrameStatus::OK) {
+                ProtocolMetrics::frameRejected(status);
+                LOG_FRAME_STATUS(status, frame, size);
+                return status;
+            }
+            ProtocolMetrics::frameDecoded(ProtocolConstants::FrameType::FRAGMENT, size);
+            statistics.fragments++;
+            expire(nowNs);
+
+            if (count > MAX_FRAGMENTS_PER_MESSAGE) {
+                statistics.tooLarge++;
+                LOG(LogLevel::ERROR, "Fragmented message exceeds reassembly buffer");
+                return FrameStatus::OK;
+            }
+
+            Slot *found = slotFor(messageID, count, index, payload, nowNs);
+            if (!found) {
+                statistics.lateDuplicates++;
+                return FrameStatus::OK;
+            }
+            Slot &slot = *found;
+            slot.lastActivityNs = nowNs;
+            if (slot.seen[index / 64] >> (index % 64) & 1) {
+                statistics.duplicates++;
+                return FrameStatus::OK;
+            }
+
+            size_t headerSize = HEADER_SIZE;
+            if (index == 0) {
+                slot.kind = payload[6];
+                slot.totalLength = ByteOrder::readUint32LE(&payload[7]);
+                slot.crc = ByteOrder::readUint16LE(&payload[11]);
+                headerSize = FIRST_HEADER_SIZE;
+            }
+            const size_t chunk = length - headerSize;
+            const size_t offset = offsetOf(index);
+            if (offset + chunk > MaxMessageSize) {
+                slot.active = false;
+                statistics.tooLarge++;
+                LOG(LogLevel::ERROR, "Fragmented message exceeds reassembly buffer");
+                return FrameStatus::OK;
+            }
+            memcpy(&slot.buffer[offset], &payload[headerSize], chunk);
+            slot.seen[index / 64] |= uint64_t{1} << (index % 64);
+            slot.bytes += chunk;
+            slot.received++;
+
+            if (slot.received == slot.count) complete(slot, nowNs);
+            return FrameStatus::OK;
+        }
+
+        FrameStatus handleFrame(const uint8_t *frame, const size_t size) {
+            return handleFrame(frame, size, nowNs());
+        }
+
+        //FrameHandler adapter for FrameStreamDecoder; context is the reassembler
+        static void frameHandler(void *context, const uint8_t *frame, const size_t size) {
+            static_cast<Reassembler *>(context)->handleFrame(frame, size);
+        }
+
+        size_t activeMessages() const {
+            size_t n = 0;
+            for (size_t i = 0; i < Slots; ++i) n += slots[i].active ? 1 : 0;
+            return n;
+        }
+
+        const Stats &stats() const { return statistics; }
+    };
+}
+
+#endif //SMARTDRIVE_FRAGMENTATION_H
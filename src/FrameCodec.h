@@ -0,0 +1,257 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_FRAMECODEC_H
+#define SMARTDRIVE_FRAMECODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "FrameView.h"
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../types/FrameTraits.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/CRC16.h"
+#include "../utils/Logger.h"
+
+//Header-only, devirtualized codec. Everything about a payload type comes from FrameTraits<T>,
+//so the frame size, the memcpy and the CRC length are compile-time constants and the whole
+//encode/decode inlines into the caller. Adding a frame type only needs a FrameTraits specialization.
+namespace FrameCodec {
+    template<typename T>
+    constexpr size_t frameSize = FrameTraits<T>::payloadSize + ProtocolConstants::PROTOCOL_OVERHEAD;
+
+    //Runtime-sized frame builder for payloads that have no fixed layout
+    inline size_t encodeFrame(const ProtocolConstants::FrameType type,
+                              const void *payload,
+                              const size_t payloadSize,
+                              uint8_t *out,
+                              const size_t capacity) {
+        if (payloadSize > ProtocolConstants::MAX_PAYLOAD_SIZE) {
+            LOG(LogLevel::ERROR, "Payload exceeds max size");
+            return 0;
+        }
+
+        if (capacity < payloadSize + ProtocolConstants::PROTOCOL_OVERHEAD) {
+            LOG(LogLevel::ERROR, "Output buffer too small");
+            return 0;
+        }
+
+        const ProtocolMetrics::LatencyTimer timer(ProtocolMetrics::Operation::ENCODE);
+        out[0] = ProtocolConstants::encodeHeader(type);
+        out[1] = static_cast<uint8_t>(payloadSize);
+        memcpy(&out[ProtocolConstants::HEADER_SIZE], payload, payloadSize);
+
+        const size_t crcOffset = ProtocolConstants::HEADER_SIZE + payloadSize;
+        ByteOrder::writeUint16LE(&out[crcOffset], CRC16::compute(out, crcOffset));
+        ProtocolMetrics::frameEncoded(type, crcOffset + ProtocolConstants::CRC_SIZE);
+        return crcOffset + ProtocolConstants::CRC_SIZE;
+    }
+
+    //Writes a complete frame; out must hold frameSize<T> bytes
+    template<typename T>
+    inline void encodeUnchecked(const T &value, uint8_t *out) {
+        using Traits = FrameTraits<T>;
+        static_assert(Traits::payloadSize <= ProtocolConstants::MAX_PAYLOAD_SIZE, "Payload exceeds max size");
+        constexpr size_t crcOffset = ProtocolConstants::HEADER_SIZE + Traits::payloadSize;
+
+        out[0] = ProtocolConstants::encodeHeader(Traits::type);
+        out[1] = static_cast<uint8_t>(Traits::payloadSize);
+        memcpy(&out[ProtocolConstants::HEADER_SIZE], &value, Traits::payloadSize);
+        ByteOrder::writeUint16LE(&out[crcOffset], CRC16::computeFixed<crcOffset>(out));
+    }
+
+    template<typename T>
+    inline size_t serialize(const T &value, uint8_t *out, const size_t capacity) {
+        if (capacity < frameSize<T>) {
+            LOG(LogLevel::ERROR, "Output buffer too small");
+            return 0;
+        }
+        const ProtocolMetrics::LatencyTimer timer(ProtocolMetrics::Operation::ENCODE);
+        encodeUnchecked(value, out);
+        ProtocolMetrics::frameEncoded(FrameTraits<T>::type, frameSize<T>);
+        return frameSize<T>;
+    }
+
+    //Same checks, in the same order, as the original BinaryProtocol::parseFrame
+    template<typename T>
+    inline FrameStatus check(const uint8_t *data, const size_t size) {
+        using Traits = FrameTraits<T>;
+        constexpr size_t crcOffset = ProtocolConstants::HEADER_SIZE + Traits::payloadSize;
+
+        if (size < ProtocolConstants::PROTOCOL_OVERHEAD) {
+            return FrameStatus::TOO_SMALL;
+        }
+        if (!ProtocolConstants::isValidHeader(data[0])) {
+            return FrameStatus::INVALID_HEADER;
+        }
+        if (ProtocolConstants::decodeType(data[0]) != Traits::type) {
+            return FrameStatus::TYPE_MISMATCH;
+        }
+        if (size != static_cast<size_t>(data[1]) + ProtocolConstants::PROTOCOL_OVERHEAD) {
+            return FrameStatus::INVALID_SIZE;
+        }
+        if (data[1] != Traits::payloadSize) {
+            return FrameStatus::PAYLOAD_SIZE_MISMATCH;
+        }
+        if (ByteOrder::readUint16LE(&data[crcOffset]) != CRC16::computeFixed<crcOffset>(data)) {
+            return FrameStatus::CRC_MISMATCH;
+        }
+        return FrameStatus::OK;
+    }
+
+    template<typename T>
+    inline FrameStatus deserialize(const uint8_t *data, const size_t size, T &out) {
+        const ProtocolMetrics::LatencyTimer timer(ProtocolMetrics::Operation::DECODE);
+        const FrameStatus status = check<T>(data, size);
+        if (status != FrameStatus::OK) {
+            ProtocolMetrics::frameRejected(status);
+            LOG_FRAME_STATUS(status, data, size);
+            return status;
+        }
+        memcpy(static_cast<void *>(&out), &data[ProtocolConstants::HEADER_SIZE], FrameTraits<T>::payloadSize);
+        ProtocolMetrics::frameDecoded(FrameTraits<T>::type, frameSize<T>);
+        return FrameStatus::OK;
+    }
+
+    //Frames per multi-buffer CRC group in the batch paths
+    constexpr size_t BATCH_LANES = 4;
+
+    //Encodes count values as back-to-back frames, byte-identical to calling serialize() on each.
+    //Returns the bytes written, or 0 (nothing written) if the whole batch does not fit.
+    template<typename T>
+    inline size_t serializeBatch(const T *values, const size_t count, uint8_t *out, const size_t capacity) {
+        using Traits = FrameTraits<T>;
+        constexpr size_t stride = frameSize<T>;
+        constexpr size_t crcOffset = ProtocolConstants::HEADER_SIZE + Traits::payloadSize;
+
+        if (count > capacity / stride) {
+            LOG(LogLevel::ERROR, "Output buffer too small");
+            return 0;
+        }
+
+        size_t index = 0;
+        for (; index + BATCH_LANES <= count; index += BATCH_LANES) {
+            const uint8_t *frames[BATCH_LANES];
+            for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                uint8_t *frame = &out[(index + lane) * stride];
+                frame[0] = ProtocolConstants::encodeHeader(Traits::type);
+                frame[1] = static_cast<uint8_t>(Traits::payloadSize);
+                memcpy(&frame[ProtocolConstants::HEADER_SIZE], &values[index + lane], Traits::payloadSize);
+                frames[lane] = frame;
+            }
+
+            uint16_t crcs[BATCH_LANES];
+            CRC16::computeFixedMulti<crcOffset, BATCH_LANES>(frames, crcs);
+            for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                ByteOrder::writeUint16LE(&out[(index + lane) * stride + crcOffset], crcs[lane]);
+            }
+        }
+        for (; index < count; ++index) {
+            encodeUnchecked(values[index], &out[index * stride]);
+        }
+        ProtocolMetrics::frameEncoded(Traits::type, count * stride, count);
+        return count * stride;
+    }
+
+    //One entry of a mixed batch
+    struct FrameRef {
+        ProtocolConstants::FrameType type;
+        const void *payload;
+        size_t payloadSize;
+    };
+
+    template<typename T>
+    FrameRef frameRef(const T &value) {
+        return {FrameTraits<T>::type, &value, FrameTraits<T>::payloadSize};
+    }
+
+    //Mixed frame types into one buffer; returns 0 (nothing written) if the whole batch does not fit
+    inline size_t serializeFrames(const FrameRef *frames, const size_t count, uint8_t *out, const size_t capacity) {
+        size_t required = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (frames[i].payloadSize > ProtocolConstants::MAX_PAYLOAD_SIZE) {
+                LOG(LogLevel::ERROR, "Payload exceeds max size");
+                return 0;
+            }
+            required += frames[i].payloadSize + ProtocolConstants::PROTOCOL_OVERHEAD;
+        }
+        if (required > capacity) {
+            LOG(LogLevel::ERROR, "Output buffer too small");
+            return 0;
+        }
+
+        size_t offset = 0;
+        for (size_t i = 0; i < count; ++i) {
+            offset += encodeFrame(frames[i].type, frames[i].payload, frames[i].payloadSize,
+                                  &out[offset], capacity - offset);
+        }
+        return offset;
+    }
+
+    //Validates and decodes a buffer of back-to-back T frames in one sweep. On failure the status of
+    //the bad frame is returned and decodedCount tells how many frames were copied to out before it.
+    template<typename T>
+    inline FrameStatus deserializeBatch(const uint8_t *data, const size_t size,
+                                        T *out, const size_t capacity, size_t &decodedCount) {
+        using Traits = FrameTraits<T>;
+        constexpr size_t stride = frameSize<T>;
+        constexpr size_t crcOffset = ProtocolConstants::HEADER_SIZE + Traits::payloadSize;
+        constexpr uint8_t header = ProtocolConstants::encodeHeader(Traits::type);
+
+        decodedCount = 0;
+        const size_t count = size / stride;
+        if (size % stride != 0 || count > capacity) {
+            ProtocolMetrics::frameRejected(FrameStatus::INVALID_SIZE);
+            LOG_FRAME_STATUS(FrameStatus::INVALID_SIZE, data, size);
+            return FrameStatus::INVALID_SIZE;
+        }
+
+        for (size_t index = 0; index < count; index += BATCH_LANES) {
+            const size_t lanes = count - index < BATCH_LANES ? count - index : BATCH_LANES;
+            const uint8_t *frames[BATCH_LANES] = {};
+            uint16_t crcs[BATCH_LANES];
+
+            //Lanes before the first bad header are still CRC-checked and delivered in order
+            size_t valid = 0;
+            for (; valid < lanes; ++valid) {
+                frames[valid] = &data[(index + valid) * stride];
+                if (frames[valid][0] != header || frames[valid][1] != Traits::payloadSize) break;
+            }
+
+            if (valid == BATCH_LANES) {
+                CRC16::computeFixedMulti<crcOffset, BATCH_LANES>(frames, crcs);
+            } else {
+                for (size_t lane = 0; lane < valid; ++lane) {
+                    crcs[lane] = CRC16::computeFixed<crcOffset>(frames[lane]);
+                }
+            }
+
+            for (size_t lane = 0; lane < valid; ++lane) {
+                if (ByteOrder::readUint16LE(&frames[lane][crcOffset]) != crcs[lane]) {
+                    ProtocolMetrics::frameDecoded(Traits::type, decodedCount * stride, decodedCount);
+                    ProtocolMetrics::frameRejected(FrameStatus::CRC_MISMATCH);
+                    LOG_FRAME_STATUS(FrameStatus::CRC_MISMATCH, frames[lane], stride);
+                    return FrameStatus::CRC_MISMATCH;
+                }
+                memcpy(static_cast<void *>(&out[decodedCount]), &frames[lane][ProtocolConstants::HEADER_SIZE],
+                       Traits::payloadSize);
+                decodedCount++;
+            }
+
+            if (valid < lanes) {
+                const FrameStatus status = check<T>(frames[valid], stride);
+                ProtocolMetrics::frameDecoded(Traits::type, decodedCount * stride, decodedCount);
+                ProtocolMetrics::frameRejected(status);
+                LOG_FRAME_STATUS(status, frames[valid], stride);
+                return status;
+            }
+        }
+        ProtocolMetrics::frameDecoded(Traits::type, decodedCount * stride, decodedCount);
+        return FrameStatus::OK;
+    }
+}
+
+#endif //SMARTDRIVE_FRAMECODEC_H
@@ -0,0 +1,206 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_FRAMESTREAMDECODER_H
+#define SMARTDRIVE_FRAMESTREAMDECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/CRC16.h"
+
+//Called with a complete, CRC-checked frame (header + length + payload + CRC).
+//The pointer may reference the caller's input or the decoder's internal buffer and is only valid during the call.
+using FrameHandler = void (*)(void *context, const uint8_t *frame, size_t frameSize);
+
+//Stateful framer for arbitrary byte chunks (partial frames, several frames, line noise).
+//Frame boundaries come from the header pattern, the length byte and the CRC. Complete frames inside
+//a chunk are dispatched in place; only a frame split across chunks is copied into the fixed internal buffer.
+//After a bad candidate the scan restarts at the byte after its header, never at bytes already discarded.
+class FrameStreamDecoder {
+public:
+    struct Stats {
+        uint64_t framesDecoded = 0;
+        uint64_t framesUnhandled = 0;
+        uint64_t bytesDiscarded = 0;
+        uint64_t crcErrors = 0;
+        uint64_t lengthErrors = 0;
+    };
+
+private:
+    enum class Candidate : uint8_t {
+        NEED_MORE,
+        VALID,
+        INVALID
+    };
+
+    struct HandlerEntry {
+        FrameHandler handler = nullptr;
+        void *context = nullptr;
+    };
+
+    HandlerEntry handlers[ProtocolConstants::MAX_FRAME_TYPES];
+    uint8_t buffer[ProtocolConstants::MAX_FRAME_SIZE];
+    size_t buffered = 0; //buffer[0] is always a valid header when non-zero
+    Stats statistics;
+
+    //Header byte at frame[0] has already been checked
+    Candidate checkCandidate(const uint8_t *frame, const size_t available, size_t &frameSize) {
+        if (available < ProtocolConstants::HEADER_SIZE) {
+            return Candidate::NEED_MORE;
+        }
+
+        const uint8_t payloadLength = frame[1];
+        if (payloadLength > ProtocolConstants::MAX_PAYLOAD_SIZE) {
+            statistics.lengthErrors++;
+            return Candidate::INVALID;
+        }
+
+        frameSize = payloadLength + ProtocolConstants::PROTOCOL_OVERHEAD;
+        if (available < frameSize) {
+            return Candidate::NEED_MORE;
+        }
+
+        const size_t crcOffset = ProtocolConstants::HEADER_SIZE + payloadLength;
+        if (ByteOrder::readUint16LE(&frame[crcOffset]) != CRC16::compute(frame, crcOffset)) {
+            statistics.crcErrors++;
+            return Candidate::INVALID;
+        }
+        return Candidate::VALID;
+    }
+
+    void dispatch(const uint8_t *frame, const size_t frameSize) {
+        statistics.framesDecoded++;
+        const HandlerEntry &entry = handlers[frame[0] >> ProtocolConstants::TYPE_SHIFT];
+        if (entry.handler) {
+            entry.handler(entry.context, frame, frameSize);
+        } else {
+            statistics.framesUnhandled++;
+        }
+    }
+
+    //Index of the first valid header in [from, size), or size if there is none
+    static size_t findHeader(const uint8_t *data, size_t from, const size_t size) {
+        while (from < size && !ProtocolConstants::isValidHeader(data[from])) {
+            ++from;
+        }
+        return from;
+    }
+
+    //Bytes skipped while hunting for the next frame boundary
+    void discard(const size_t count) {
+        if (count == 0) return;
+        statistics.bytesDiscarded += count;
+        ProtocolMetrics::resyncBytes(count);
+    }
+
+    //Drops buffer[0..count) and slides the remainder down to the next header candidate
+    void discardBuffered(const size_t count) {
+        const size_t next = findHeader(buffer, count, buffered);
+        discard(next - count);
+        buffered -= next;
+        if (buffered > 0) {
+            memmove(buffer, &buffer[next], buffered);
+        }
+    }
+
+    //Resolves as many candidates from the internal buffer as its contents allow
+    void drainBuffer() {
+        while (buffered > 0) {
+            size_t frameSize = 0;
+            const Candidate candidate = checkCandidate(buffer, buffered, frameSize);
+            if (candidate == Candidate::NEED_MORE) {
+                return;
+            }
+            if (candidate == Candidate::VALID) {
+                dispatch(buffer, frameSize);
+                discardBuffered(frameSize);
+            } else {
+                discard(1);
+                discardBuffered(1);
+            }
+        }
+    }
+
+    //Bytes the buffered candidate still needs before it can be resolved
+    size_t bytesNeeded() const {
+        if (buffered < ProtocolConstants::HEADER_SIZE) {
+            return ProtocolConstants::HEADER_SIZE - buffered;
+        }
+        return buffer[1] + ProtocolConstants::PROTOCOL_OVERHEAD - buffered;
+    }
+
+public:
+    FrameStreamDecoder() {
+        memset(buffer, 0, sizeof(buffer));
+    }
+
+    void setHandler(const ProtocolConstants::FrameType type, const FrameHandler handler, void *context = nullptr) {
+        HandlerEntry &entry = handlers[static_cast<uint8_t>(type)];
+        entry.handler = handler;
+        entry.context = context;
+    }
+
+    void feed(const uint8_t *data, size_t size) {
+        //Finish a frame that was split across chunks
+        while (buffered > 0 && size > 0) {
+            const size_t take = bytesNeeded() < size ? bytesNeeded() : size;
+            memcpy(&buffer[buffered], data, take);
+            buffered += take;
+            data += take;
+            size -= take;
+            drainBuffer();
+        }
+
+        //Scan the rest of the chunk in place
+        size_t offset = 0;
+        while (offset < size) {
+            const size_t header = findHeader(data, offset, size);
+            discard(header - offset);
+            offset = header;
+            if (offset == size) {
+                break;
+            }
+
+            size_t frameSize = 0;
+            const Candidate candidate = checkCandidate(&data[offset], size - offset, frameSize);
+            if (candidate == Candidate::VALID) {
+                dispatch(&data[offset], frameSize);
+                offset += frameSize;
+            } else if (candidate == Candidate::INVALID) {
+                discard(1);
+                offset++;
+            } else {
+                //Partial frame at the end of the chunk; always shorter than MAX_FRAME_SIZE
+                buffered = size - offset;
+                memcpy(buffer, &data[offset], buffered);
+                break;
+            }
+        }
+    }
+
+    void reset() {
+        buffered = 0;
+        statistics = Stats();
+    }
+
+    size_t pendingBytes() const { return buffered; }
+
+    //Moves the buffered partial frame (at most MAX_FRAME_SIZE bytes) to out and forgets it, so one
+    //decoder can serve many streams that each keep their own tail; feeding the tail back first
+    //restores the stream
+    size_t takePending(uint8_t *out) {
+        const size_t count = buffered;
+        memcpy(out, buffer, count);
+        buffered = 0;
+        return count;
+    }
+
+    const Stats &stats() const { return statistics; }
+};
+
+#endif //SMARTDRIVE_FRAMESTREAMDECODER_H
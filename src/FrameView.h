@@ -0,0 +1,253 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_FRAMEVIEW_H
+#define SMARTDRIVE_FRAMEVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../constants/ProtocolConstants.h"
+#include "../types/FrameTraits.h"
+#include "../types/ProtocolTypes.h"
+#include "../types/RobotData.h"
+#include "../types/ValueSource.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/CRC16.h"
+#include "../utils/Logger.h"
+
+enum class FrameStatus : uint8_t {
+    OK = 0,
+    TOO_SMALL,
+    INVALID_HEADER,
+    TYPE_MISMATCH,
+    INVALID_SIZE,
+    PAYLOAD_SIZE_MISMATCH,
+    CRC_MISMATCH,
+    MALFORMED_PAYLOAD,
+    BUFFER_TOO_SMALL //the caller's output buffer, not the frame; never counted as a reject
+};
+
+constexpr const char *frameStatusToString(const FrameStatus s) {
+    switch (s) {
+        case FrameStatus::OK: return "OK";
+        case FrameStatus::TOO_SMALL: return "Frame too small";
+        case FrameStatus::INVALID_HEADER: return "Invalid header";
+        case FrameStatus::TYPE_MISMATCH: return "Frame type mismatch";
+        case FrameStatus::INVALID_SIZE: return "Invalid frame size";
+        case FrameStatus::PAYLOAD_SIZE_MISMATCH: return "Payload size mismatch";
+        case FrameStatus::CRC_MISMATCH: return "CRC mismatch";
+        case FrameStatus::MALFORMED_PAYLOAD: return "Malformed payload";
+        case FrameStatus::BUFFER_TOO_SMALL: return "Output buffer too small";
+        default: return "Unknown";
+    }
+}
+
+constexpr LogCode frameStatusToLogCode(const FrameStatus s) {
+    return static_cast<LogCode>(s);
+}
+
+static_assert(frameStatusToLogCode(FrameStatus::CRC_MISMATCH) == LogCode::CRC_MISMATCH &&
+              frameStatusToLogCode(FrameStatus::MALFORMED_PAYLOAD) == LogCode::MALFORMED_PAYLOAD,
+              "FrameStatus and LogCode numbering must match");
+
+//Logs a rejected frame with its header byte and size as the record arguments
+#define LOG_FRAME_STATUS(status, data, size) \
+    LOG_CODE(LogLevel::ERROR, frameStatusToLogCode(status), frameStatusToString(status), \
+             (size) > 0 ? (data)[0] : 0, static_cast<uint32_t>(size))
+
+//Typed, alignment-safe accessors over a payload that stays in the receive buffer.
+//Every read is a memcpy from a fixed offset, so packed fields never need aligned access.
+template<typename T>
+class PayloadView;
+
+namespace detail {
+    class PayloadReader {
+    protected:
+        const uint8_t *payload;
+
+        template<typename V>
+        V load(const size_t offset) const {
+            V value;
+            memcpy(&value, &payload[offset], sizeof(V));
+            return value;
+        }
+
+    public:
+        explicit PayloadReader(const uint8_t *payload) : payload(payload) {
+        }
+
+        const uint8_t *data() const { return payload; }
+    };
+}
+
+template<>
+class PayloadView<ValueSource> : public detail::PayloadReader {
+public:
+    //ValueSource wire layout: type(2) + data(16)
+    static constexpr size_t TYPE_OFFSET = 0;
+    static constexpr size_t DATA_OFFSET = 2;
+    static constexpr size_t DATA_SIZE = 16;
+
+    using PayloadReader::PayloadReader;
+
+    ValueType valueType() const { return load<ValueType>(TYPE_OFFSET); }
+
+    template<typename V>
+    V value() const {
+        static_assert(std::is_same_v<V, int32_t> || std::is_same_v<V, uint16_t> || std::is_same_v<V, float>,
+                      "Invalid type");
+        ValueType expected = ValueType::FLOAT;
+        if constexpr (std::is_same_v<V, int32_t>) expected = ValueType::INT32;
+        else if constexpr (std::is_same_v<V, uint16_t>) expected = ValueType::UINT16;
+
+        if (valueType() != expected) return V{};
+        return load<V>(DATA_OFFSET);
+    }
+
+    //Not null-terminated if the sender filled all 16 bytes; use stringLength()
+    const char *stringData() const { return reinterpret_cast<const char *>(&payload[DATA_OFFSET]); }
+
+    size_t stringLength() const {
+        if (valueType() != ValueType::STRING) return 0;
+        const void *end = memchr(&payload[DATA_OFFSET], '\0', DATA_SIZE);
+        return end ? static_cast<const uint8_t *>(end) - &payload[DATA_OFFSET] : DATA_SIZE;
+    }
+
+    ValueSource materialize() const {
+        ValueSource value;
+        memcpy(static_cast<void *>(&value), payload, sizeof(ValueSource));
+        return value;
+    }
+};
+
+template<>
+class PayloadView<TelemetryData> : public PayloadView<ValueSource> {
+public:
+    static constexpr size_t SOURCE_ID_OFFSET = sizeof(ValueSource);
+    static constexpr size_t TIMESTAMP_OFFSET = SOURCE_ID_OFFSET + sizeof(uint16_t);
+
+    using PayloadView<ValueSource>::PayloadView;
+
+    uint16_t sourceID() const { return load<uint16_t>(SOURCE_ID_OFFSET); }
+    uint32_t timestamp() const { return load<uint32_t>(TIMESTAMP_OFFSET); }
+
+    TelemetryData materialize() const {
+        TelemetryData telemetry;
+        memcpy(static_cast<void *>(&telemetry), payload, sizeof(TelemetryData));
+        return telemetry;
+    }
+};
+
+template<>
+class PayloadView<SettingsData> : public PayloadView<ValueSource> {
+public:
+    static constexpr size_t SETTINGS_ID_OFFSET = sizeof(ValueSource);
+
+    using PayloadView<ValueSource>::PayloadView;
+
+    uint16_t settingsID() const { return load<uint16_t>(SETTINGS_ID_OFFSET); }
+
+    SettingsData materialize() const {
+        SettingsData settings;
+        memcpy(static_cast<void *>(&settings), payload, sizeof(SettingsData));
+        return settings;
+    }
+};
+
+template<>
+class PayloadView<Command> : public detail::PayloadReader {
+public:
+    using PayloadReader::PayloadReader;
+
+    uint16_t commandType() const { return load<uint16_t>(offsetof(Command, commandType)); }
+    float w() const { return load<float>(offsetof(Command, w)); }
+    float x() const { return load<float>(offsetof(Command, x)); }
+    float y() const { return load<float>(offsetof(Command, y)); }
+    float z() const { return load<float>(offsetof(Command, z)); }
+    int16_t s() const { return load<int16_t>(offsetof(Command, s)); }
+    int16_t t() const { return load<int16_t>(offsetof(Command, t)); }
+    int16_t u() const { return load<int16_t>(offsetof(Command, u)); }
+    int16_t v() const { return load<int16_t>(offsetof(Command, v)); }
+
+    Command materialize() const { return load<Command>(0); }
+};
+
+template<>
+class PayloadView<DiscoveryResponse> : public detail::PayloadReader {
+public:
+    using PayloadReader::PayloadReader;
+
+    uint8_t moduleCount() const { return load<uint8_t>(offsetof(DiscoveryResponse, moduleCount)); }
+
+    //An empty ModuleInfo past moduleCount()
+    ModuleInfo module(const size_t index) const {
+        if (index >= moduleCount() || index >= MAX_NUM_MODULES) return ModuleInfo{};
+        return load<ModuleInfo>(offsetof(DiscoveryResponse, modules) + index * sizeof(ModuleInfo));
+    }
+
+    DiscoveryResponse materialize() const { return load<DiscoveryResponse>(0); }
+};
+
+//Validates header, length and CRC once, then exposes the payload in place without copying it.
+//The view borrows the buffer; it must outlive the view.
+class FrameView {
+private:
+    const uint8_t *frame = nullptr;
+    size_t frameSize = 0;
+    FrameStatus frameStatus = FrameStatus::TOO_SMALL;
+
+public:
+    static FrameStatus validate(const uint8_t *data, const size_t size) {
+        if (size < ProtocolConstants::PROTOCOL_OVERHEAD) {
+            return FrameStatus::TOO_SMALL;
+        }
+
+        if (!ProtocolConstants::isValidHeader(data[0])) {
+            return FrameStatus::INVALID_HEADER;
+        }
+
+        const uint8_t payloadLength = data[1];
+        if (payloadLength > ProtocolConstants::MAX_PAYLOAD_SIZE ||
+            size != static_cast<size_t>(payloadLength) + ProtocolConstants::PROTOCOL_OVERHEAD) {
+            return FrameStatus::INVALID_SIZE;
+        }
+
+        const size_t crcOffset = ProtocolConstants::HEADER_SIZE + payloadLength;
+        if (ByteOrder::readUint16LE(&data[crcOffset]) != CRC16::compute(data, crcOffset)) {
+            return FrameStatus::CRC_MISMATCH;
+        }
+        return FrameStatus::OK;
+    }
+
+    FrameView() = default;
+
+    FrameView(const uint8_t *data, const size_t size)
+        : frame(data), frameSize(size), frameStatus(validate(data, size)) {
+    }
+
+    bool valid() const { return frameStatus == FrameStatus::OK; }
+    FrameStatus status() const { return frameStatus; }
+
+    ProtocolConstants::FrameType type() const { return ProtocolConstants::decodeType(frame[0]); }
+
+    const uint8_t *data() const { return frame; }
+    size_t size() const { return frameSize; }
+
+    const uint8_t *payload() const { return &frame[ProtocolConstants::HEADER_SIZE]; }
+    size_t payloadSize() const { return frame[1]; }
+
+    template<typename T>
+    bool is() const {
+        return valid() && type() == FrameTraits<T>::type && payloadSize() == FrameTraits<T>::payloadSize;
+    }
+
+    //Caller must have checked is<T>()
+    template<typename T>
+    PayloadView<T> as() const {
+        return PayloadView<T>(payload());
+    }
+};
+
+#endif //SMARTDRIVE_FRAMEVIEW_H
@@ -0,0 +1,143 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_LATESTTELEMETRYTABLE_H
+#define SMARTDRIVE_LATESTTELEMETRYTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include "../types/RobotData.h"
+
+//Most recent TelemetryData per sourceID, for control loops that poll while decoder threads write.
+//Each slot is a seqlock over two copies of the sample: a writer fills the copy readers are not
+//using and then publishes it, so a read only has to retry if two further writes to the same source
+//complete during its 24-byte copy. Readers never take a lock or write shared memory; writers only
+//wait for other writers of the same sourceID.
+template<size_t Capacity = 256>
+class LatestTelemetryTable {
+public:
+    static constexpr size_t WORDS = sizeof(TelemetryData) / sizeof(uint64_t);
+    static constexpr size_t MAX_SNAPSHOT_SOURCES = 32;
+    static_assert(sizeof(TelemetryData) % sizeof(uint64_t) == 0, "TelemetryData must be a whole number of words");
+
+private:
+    //sequence is odd while a write is in progress; sequence / 2 writes have completed and the newest
+    //one is in copies[(sequence / 2) & 1]
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> copies[2][WORDS] = {};
+    };
+
+    Slot slots[Capacity];
+
+    static void load(const std::atomic<uint64_t> *words, TelemetryData &out) {
+        uint64_t raw[WORDS];
+        for (size_t i = 0; i < WORDS; ++i) raw[i] = words[i].load(std::memory_order_relaxed);
+        memcpy(static_cast<void *>(&out), raw, sizeof(raw));
+    }
+
+    static void store(std::atomic<uint64_t> *words, const TelemetryData &value) {
+        uint64_t raw[WORDS];
+        memcpy(raw, &value, sizeof(raw));
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(raw[i], std::memory_order_relaxed);
+    }
+
+    //Copies the published sample of slot as of sequence begin; false if it may have been overwritten
+    static bool readSlot(const Slot &slot, const uint64_t begin, TelemetryData &out) {
+        load(slot.copies[(begin >> 1) & 1], out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        //The copy just read is next rewritten by the write that starts two publications later
+        return slot.sequence.load(std::memory_order_relaxed) - (begin & ~uint64_t(1)) <= 2;
+    }
+
+public:
+    static constexpr size_t capacity() { return Capacity; }
+
+    //Stores telemetry as the latest sample of its source. Returns false if sourceID is out of range
+    //or the sample is older than the stored one (decoder threads may finish out of order).
+    bool update(const TelemetryData &telemetry) {
+        if (telemetry.sourceID >= Capacity) return false;
+        Slot &slot = slots[telemetry.sourceID];
+
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        for (;;) {
+            if ((sequence & 1) == 0 &&
+                slot.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                                    std::memory_order_relaxed)) {
+                break;
+            }
+            std::this_thread::yield();
+            sequence = slot.sequence.load(std::memory_order_relaxed);
+        }
+
+        const uint64_t writes = sequence >> 1;
+        if (writes > 0) {
+            TelemetryData stored;
+            load(slot.copies[writes & 1], stored);
+            if (static_cast<int32_t>(telemetry.timestamp - stored.timestamp) < 0) {
+                slot.sequence.store(sequence, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        store(slot.copies[(writes + 1) & 1], telemetry);
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    //Latest sample of sourceID; false if the source has never been updated or is out of range
+    bool read(const uint16_t sourceID, TelemetryData &out) const {
+        if (sourceID >= Capacity) return false;
+        const Slot &slot = slots[sourceID];
+        for (;;) {
+            const uint64_t begin = slot.sequence.load(std::memory_order_acquire);
+            if (begin < 2) return false;
+            if (readSlot(slot, begin, out)) return true;
+        }
+    }
+
+    //Number of accepted updates for sourceID, so a poller can tell a fresh sample from a repeat
+    uint64_t version(const uint16_t sourceID) const {
+        if (sourceID >= Capacity) return 0;
+        return slots[sourceID].sequence.load(std::memory_order_acquire) >> 1;
+    }
+
+    //Reads count sources as they all were at one instant: collects every slot, then checks that no
+    //sequence moved in the meantime. Returns false if a source has never been updated or is out of
+    //range, if count exceeds MAX_SNAPSHOT_SOURCES, or if writers kept invalidating the collect for
+    //maxAttempts rounds.
+    bool snapshot(const uint16_t *sourceIDs, const size_t count, TelemetryData *out, const size_t maxAttempts = 64) const {
+        uint64_t sequences[MAX_SNAPSHOT_SOURCES];
+        if (count > MAX_SNAPSHOT_SOURCES) return false;
+        for (size_t i = 0; i < count; ++i) {
+            if (sourceIDs[i] >= Capacity) return false;
+        }
+
+        for (size_t attempt = 0; attempt < maxAttempts; ++attempt) {
+            for (size_t i = 0; i < count; ++i) {
+                const Slot &slot = slots[sourceIDs[i]];
+                sequences[i] = slot.sequence.load(std::memory_order_acquire);
+                if (sequences[i] < 2) return false;
+                load(slot.copies[(sequences[i] >> 1) & 1], out[i]);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            bool valid = true;
+            for (size_t i = 0; i < count && valid; ++i) {
+                valid = slots[sourceIDs[i]].sequence.load(std::memory_order_relaxed) == sequences[i];
+            }
+            if (valid) return true;
+        }
+        return false;
+    }
+
+    //TelemetryHandler adapter; context is the table
+    static void handler(void *context, const TelemetryData &telemetry) {
+        static_cast<LatestTelemetryTable *>(context)->update(telemetry);
+    }
+};
+
+#endif //SMARTDRIVE_LATESTTELEMETRYTABLE_H
@@ -0,0 +1,348 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_MODULEREGISTRY_H
+#define SMARTDRIVE_MODULEREGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../types/ProtocolTypes.h"
+#include "../utils/Logger.h"
+
+//Multi-frame DISCOVERY for rigs with more than MAX_NUM_MODULES modules. A paged payload is
+//  generation(1) pageIndex(1) pageCount(1) then up to MODULES_PER_PAGE packed ModuleInfo entries
+//and carries only populated entries. A payload of exactly sizeof(DiscoveryResponse) is the legacy
+//single-frame form; paged lengths are 3 mod 7 and the legacy length is 1 mod 7, so they never collide.
+namespace DiscoveryPaging {
+    constexpr size_t PAGE_HEADER_SIZE = 3;
+    constexpr size_t MODULES_PER_PAGE = (ProtocolConstants::MAX_PAYLOAD_SIZE - PAGE_HEADER_SIZE) / sizeof(ModuleInfo);
+    constexpr size_t MAX_PAGES = 255;
+    constexpr size_t MAX_MODULES = MAX_PAGES * MODULES_PER_PAGE;
+    static_assert(PAGE_HEADER_SIZE % sizeof(ModuleInfo) != sizeof(DiscoveryResponse) % sizeof(ModuleInfo),
+                  "Paged and legacy discovery payloads must have distinct lengths");
+
+    struct Page {
+        uint8_t generation = 0;
+        uint8_t pageIndex = 0;
+        uint8_t pageCount = 0;
+        uint8_t count = 0;
+        ModuleInfo modules[MODULES_PER_PAGE > MAX_NUM_MODULES ? MODULES_PER_PAGE : MAX_NUM_MODULES];
+        bool legacy = false;
+    };
+
+    inline size_t pageCount(const size_t moduleCount) {
+        return moduleCount == 0 ? 1 : (moduleCount + MODULES_PER_PAGE - 1) / MODULES_PER_PAGE;
+    }
+
+    //Writes page pageIndex of modules as one frame; returns bytes written
+    inline size_t encodePage(const ModuleInfo *modules, const size_t count, const uint8_t generation,
+                             const size_t pageIndex, uint8_t *out, const size_t capacity) {
+        const size_t pages = pageCount(count);
+        if (count > MAX_MODULES || pageIndex >= pages) {
+            LOG(LogLevel::ERROR, "Discovery page out of range");
+            return 0;
+        }
+        const size_t first = pageIndex * MODULES_PER_PAGE;
+        const size_t inPage = count - first < MODULES_PER_PAGE ? count - first : MODULES_PER_PAGE;
+
+        uint8_t payload[ProtocolConstants::MAX_PAYLOAD_SIZE];
+        payload[0] = generation;
+        payload[1] = static_cast<uint8_t>(pageIndex);
+        payload[2] = static_cast<uint8_t>(pages);
+        if (inPage > 0) memcpy(&payload[PAGE_HEADER_SIZE], &modules[first], inPage * sizeof(ModuleInfo));
+        return FrameCodec::encodeFrame(ProtocolConstants::FrameType::DISCOVERY, payload,
+                                       PAGE_HEADER_SIZE + inPage * sizeof(ModuleInfo), out, capacity);
+    }
+
+    //Writes every page back to back (one stream write); returns bytes written, 0 if out is too small
+    inline size_t encodeAll(const ModuleInfo *modules, const size_t count, const uint8_t generation,
+                            uint8_t *out, const size_t capacity) {
+        size_t written = 0;
+        for (size_t page = 0; page < pageCount(count); ++page) {
+            const size_t size = encodePage(modules, count, generation, page, &out[written], capacity - written);
+            if (size == 0) return 0;
+            written += size;
+        }
+        return written;
+    }
+
+    //Accepts paged and legacy DISCOVERY frames
+    inline FrameStatus decodePage(const uint8_t *frame, const size_t size, Page &out) {
+        FrameStatus status = FrameView::validate(frame, size);
+        if (status == FrameStatus::OK &&
+            ProtocolConstants::decodeType(frame[0]) != ProtocolConstants::FrameType::DISCOVERY) {
+            status = FrameStatus::TYPE_MISMATCH;
+        }
+        const uint8_t *payload = &frame[ProtocolConstants::HEADER_SIZE];
+        const size_t length = status == FrameStatus::OK ? frame[1] : 0;
+        if (status == FrameStatus::OK) {
+            if (length == sizeof(DiscoveryResponse)) {
+                if (payload[0] > MAX_NUM_MODULES) status = FrameStatus::MALFORMED_PAYLOAD;
+            } else if (length < PAGE_HEADER_SIZE || (length - PAGE_HEADER_SIZE) % sizeof(ModuleInfo) != 0 ||
+                       payload[2] == 0 || payload[1] >= payload[2]) {
+                status = FrameStatus::MALFORMED_PAYLOAD;
+            }
+        }
+        if (status != FrameStatus::OK) {
+            ProtocolMetrics::frameRejected(status);
+            LOG_FRAME_STATUS(status, frame, size);
+            return status;
+        }
+
+        if (length == sizeof(DiscoveryResponse)) {
+            out.legacy = true;
+            out.generation = 0;
+            out.pageIndex = 0;
+            out.pageCount = 1;
+            out.count = payload[0];
+            memcpy(out.modules, &payload[1], out.count * sizeof(ModuleInfo));
+        } else {
+            out.legacy = false;
+            out.generation = payload[0];
+            out.pageIndex = payload[1];
+            out.pageCount = payload[2];
+            out.count = static_cast<uint8_t>((length - PAGE_HEADER_SIZE) / sizeof(ModuleInfo));
+            memcpy(out.modules, &payload[PAGE_HEADER_SIZE], out.count * sizeof(ModuleInfo));
+        }
+        ProtocolMetrics::frameDecoded(ProtocolConstants::FrameType::DISCOVERY, size);
+        return FrameStatus::OK;
+    }
+}
+
+//Set of module slots in a ModuleRegistry
+class ModuleSet {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    ModuleSet() = default;
+    explicit ModuleSet(const size_t slots) : words((slots + 63) / 64, 0) {}
+
+    void resize(const size_t slots) { words.resize((slots + 63) / 64, 0); }
+    void set(const size_t slot) { words[slot / 64] |= uint64_t{1} << (slot % 64); }
+    void reset(const size_t slot) { words[slot / 64] &= ~(uint64_t{1} << (slot % 64)); }
+    bool test(const size_t slot) const { return slot / 64 < words.size() && (words[slot / 64] >> (slot % 64) & 1); }
+
+    ModuleSet &operator&=(const ModuleSet &other) {
+        for (size_t i = 0; i < words.size(); ++i) words[i] &= i < other.words.size() ? other.words[i] : 0;
+        return *this;
+    }
+
+    size_t count() const {
+        size_t n = 0;
+        for (const uint64_t w : words) n += static_cast<size_t>(__builtin_popcountll(w));
+        return n;
+    }
+
+    bool empty() const {
+        for (const uint64_t w : words) {
+            if (w) return false;
+        }
+        return true;
+    }
+
+    template<typename Visitor>
+    void forEach(Visitor &&visit) const {
+        for (size_t i = 0; i < words.size(); ++i) {
+            for (uint64_t w = words[i]; w; w &= w - 1) visit(i * 64 + static_cast<size_t>(__builtin_ctzll(w)));
+        }
+    }
+};
+
+//What a completed discovery changed, keyed by (typeID, instanceID)
+struct DiscoveryDiff {
+    std::vector<ModuleInfo> added;
+    std::vector<ModuleInfo> removed;
+    std::vector<ModuleInfo> changed; //new capabilities of modules already known
+
+    bool empty() const { return added.empty() && removed.empty() && changed.empty(); }
+};
+
+//Modules known on one link. Each module occupies a slot; per-typeID, per-instanceID and
+//per-capability-bit ModuleSets index the slots, so queries are word-wise ANDs. handleFrame()
+//collects the pages of a discovery and, once complete, applies only the difference to what is known.
+class ModuleRegistry {
+private:
+    std::vector<ModuleInfo> modules;
+    ModuleSet occupied;
+    std::vector<size_t> freeSlots;
+    std::unordered_map<uint32_t, size_t> slotByKey;
+    std::unordered_map<uint16_t, ModuleSet> byType;
+    ModuleSet byInstance[256];
+    ModuleSet byCapability[32];
+
+    //Pages of the discovery in progress
+    uint8_t pendingGeneration = 0;
+    size_t pendingPages = 0;
+    std::vector<bool> pageSeen;
+    size_t pagesSeen = 0;
+    std::vector<ModuleInfo> collected;
+    uint64_t discoveries = 0;
+    bool haveGeneration = false; //a paged discovery has completed since the last legacy one
+    uint8_t lastGeneration = 0;
+
+    static uint32_t keyOf(const ModuleInfo &m) { return static_cast<uint32_t>(m.typeID) << 8 | m.instanceID; }
+
+    void index(const size_t slot, const ModuleInfo &m, const bool add) {
+        const uint16_t typeID = m.typeID; //ModuleInfo is packed; no references to its fields
+        for (ModuleSet *set : {&byType[typeID], &byInstance[m.instanceID]}) {
+            set->resize(modules.size());
+            add ? set->set(slot) : set->reset(slot);
+        }
+        for (uint32_t bits = m.capabilitiesBitmask; bits; bits &= bits - 1) {
+            ModuleSet &set = byCapability[__builtin_ctz(bits)];
+            set.resize(modules.size());
+            add ? set.set(slot) : set.reset(slot);
+        }
+    }
+
+    void insert(const ModuleInfo &m) {
+        size_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            modules[slot] = m;
+        } else {
+            slot = modules.size();
+            modules.push_back(m);
+            occupied.resize(modules.size());
+        }
+        occupied.set(slot);
+        slotByKey[keyOf(m)] = slot;
+        index(slot, m, true);
+    }
+
+    void remove(const size_t slot) {
+        index(slot, modules[slot], false);
+        slotByKey.erase(keyOf(modules[slot]));
+        occupied.reset(slot);
+        freeSlots.push_back(slot);
+    }
+
+    ModuleSet all() const {
+        ModuleSet s = occupied;
+        s.resize(modules.size());
+        return s;
+    }
+
+public:
+    //Replaces the known modules with modules, touching only entries that differ
+    DiscoveryDiff apply(const ModuleInfo *list, const size_t count) {
+        DiscoveryDiff diff;
+        std::unordered_map<uint32_t, const ModuleInfo *> incoming;
+        incoming.reserve(count);
+        for (size_t i = 0; i < count; ++i) incoming[keyOf(list[i])] = &list[i];
+
+        std::vector<size_t> gone;
+        occupied.forEach([&](const size_t slot) {
+            if (!incoming.count(keyOf(modules[slot]))) gone.push_back(slot);
+        });
+        for (const size_t slot : gone) {
+            diff.removed.push_back(modules[slot]);
+            remove(slot);
+        }
+
+        for (const auto &entry : incoming) {
+            const ModuleInfo &m = *entry.second;
+            const auto known = slotByKey.find(entry.first);
+            if (known == slotByKey.end()) {
+                insert(m);
+                diff.added.push_back(m);
+            } else if (modules[known->second].capabilitiesBitmask != m.capabilitiesBitmask) {
+                const size_t slot = known->second;
+                index(slot, modules[slot], false);
+                modules[slot] = m;
+                index(slot, m, true);
+                diff.changed.push_back(m);
+            }
+        }
+        discoveries++;
+        return diff;
+    }
+
+    //Feeds one DISCOVERY frame. Generations compare in serial order (0 follows 255): pages of a newer
+    //generation abandon an incomplete older one, and pages no newer than the last completed discovery
+    //or older than the one in progress are dropped.
+    //When the frame completes a discovery, its changes are applied and written to diff.
+    FrameStatus handleFrame(const uint8_t *frame, const size_t size, DiscoveryDiff *diff = nullptr) {
+        DiscoveryPaging::Page page;
+        const FrameStatus status = DiscoveryPaging::decodePage(frame, size, page);
+        if (status != FrameStatus::OK) return status;
+
+        if (page.legacy) {
+            DiscoveryDiff result = apply(page.modules, page.count);
+            if (diff) *diff = std::move(result);
+            pendingPages = 0;
+            haveGeneration = false;
+            return FrameStatus::OK;
+        }
+
+        if (haveGeneration && static_cast<int8_t>(page.generation - lastGeneration) <= 0) {
+            return FrameStatus::OK;
+        }
+        if (pendingPages != 0 && page.generation != pendingGeneration &&
+            static_cast<int8_t>(page.generation - pendingGeneration) < 0) {
+            return FrameStatus::OK;
+        }
+        if (pendingPages == 0 || page.generation != pendingGeneration || page.pageCount != pendingPages) {
+            pendingGeneration = page.generation;
+            pendingPages = page.pageCount;
+            pageSeen.assign(pendingPages, false);
+            pagesSeen = 0;
+            collected.clear();
+        }
+        if (pageSeen[page.pageIndex]) return FrameStatus::OK;
+        pageSeen[page.pageIndex] = true;
+        pagesSeen++;
+        collected.insert(collected.end(), page.modules, page.modules + page.count);
+
+        if (pagesSeen == pendingPages) {
+            DiscoveryDiff result = apply(collected.data(), collected.size());
+            if (diff) *diff = std::move(result);
+            pendingPages = 0;
+            haveGeneration = true;
+            lastGeneration = page.generation;
+        }
+        return FrameStatus::OK;
+    }
+
+    size_t size() const { return slotByKey.size(); }
+    uint64_t completedDiscoveries() const { return discoveries; }
+    const ModuleInfo &at(const size_t slot) const { return modules[slot]; }
+
+    const ModuleInfo *find(const uint16_t typeID, const uint8_t instanceID) const {
+        const auto it = slotByKey.find(static_cast<uint32_t>(typeID) << 8 | instanceID);
+        return it == slotByKey.end() ? nullptr : &modules[it->second];
+    }
+
+    //Modules that have every capability bit in mask
+    ModuleSet withCapabilities(const uint32_t mask) const {
+        ModuleSet result = all();
+        for (uint32_t bits = mask; bits; bits &= bits - 1) result &= byCapability[__builtin_ctz(bits)];
+        return result;
+    }
+
+    ModuleSet ofType(const uint16_t typeID) const {
+        const auto it = byType.find(typeID);
+        if (it == byType.end()) return ModuleSet(modules.size());
+        ModuleSet result = all();
+        result &= it->second;
+        return result;
+    }
+
+    ModuleSet withInstance(const uint8_t instanceID) const {
+        ModuleSet result = all();
+        result &= byInstance[instanceID];
+        return result;
+    }
+};
+
+#endif //SMARTDRIVE_MODULEREGISTRY_H
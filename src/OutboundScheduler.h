@@ -0,0 +1,191 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_OUTBOUNDSCHEDULER_H
+#define SMARTDRIVE_OUTBOUNDSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include "ProtocolMetrics.h"
+#include "../constants/ProtocolConstants.h"
+#include "../utils/ByteOrder.h"
+#include "../utils/Logger.h"
+
+enum class TrafficClass : uint8_t {
+    CONTROL = 0,
+    NORMAL = 1,
+    BULK = 2
+};
+
+//Orders encoded frames waiting for one link. Each FrameType maps to a TrafficClass; the highest
+//class with anything queued is served first, except that a frame whose deadline has passed goes
+//ahead of everything not yet overdue, so BULK traffic cannot starve. nextBatch() packs whole frames
+//in that order into one link write of up to MTU bytes. A COMMAND replaces any unsent COMMAND with
+//the same commandType in place, keeping the older one's queue position and deadline.
+//Thread-safe: any thread may enqueue while the link thread calls nextBatch().
+class OutboundScheduler {
+public:
+    static constexpr size_t CLASSES = 3;
+
+    struct ClassStats {
+        uint64_t enqueued = 0;
+        uint64_t sent = 0;
+        uint64_t superseded = 0;
+        uint64_t dropped = 0; //queue full
+        uint64_t deadlineMisses = 0;
+        LatencyHistogram::Snapshot latencyNs; //enqueue to nextBatch()
+    };
+
+private:
+    struct Pending {
+        uint64_t enqueuedNs;
+        uint64_t deadlineNs;
+        ProtocolConstants::FrameType type;
+        uint8_t size;
+        uint8_t data[ProtocolConstants::MAX_FRAME_SIZE];
+    };
+
+    std::mutex mutex;
+    std::deque<Pending> queues[CLASSES];
+    ClassStats classStats[CLASSES];
+    TrafficClass classOf[ProtocolConstants::MAX_FRAME_TYPES];
+    uint64_t deadlines[CLASSES] = {2000000, 20000000, 200000000};
+    size_t maxQueued;
+
+    static uint16_t commandTypeOf(const uint8_t *frame) {
+        return ByteOrder::readUint16LE(&frame[ProtocolConstants::HEADER_SIZE]);
+    }
+
+    //Class to serve next: the overdue head with the earliest deadline, else the highest non-empty class
+    int choose(const uint64_t nowNs) const {
+        int overdue = -1;
+        for (size_t c = 0; c < CLASSES; ++c) {
+            if (queues[c].empty() || queues[c].front().deadlineNs > nowNs) continue;
+            if (overdue < 0 || queues[c].front().deadlineNs < queues[overdue].front().deadlineNs) {
+                overdue = static_cast<int>(c);
+            }
+        }
+        if (overdue >= 0) return overdue;
+        for (size_t c = 0; c < CLASSES; ++c) {
+            if (!queues[c].empty()) return static_cast<int>(c);
+        }
+        return -1;
+    }
+
+public:
+    explicit OutboundScheduler(const size_t maxQueuedPerClass = 1024) : maxQueued(maxQueuedPerClass) {
+        for (TrafficClass &c : classOf) c = TrafficClass::BULK;
+        classOf[static_cast<size_t>(ProtocolConstants::FrameType::COMMAND)] = TrafficClass::CONTROL;
+        classOf[static_cast<size_t>(ProtocolConstants::FrameType::TRANSACTION)] = TrafficClass::CONTROL;
+        classOf[static_cast<size_t>(ProtocolConstants::FrameType::DISCOVERY)] = TrafficClass::NORMAL;
+        classOf[static_cast<size_t>(ProtocolConstants::FrameType::SETTINGS)] = TrafficClass::NORMAL;
+    }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void setClass(const ProtocolConstants::FrameType type, const TrafficClass trafficClass) {
+        std::lock_guard<std::mutex> lock(mutex);
+        classOf[static_cast<size_t>(type)] = trafficClass;
+    }
+
+    //Longest a frame of trafficClass should wait before it overtakes higher classes
+    void setDeadline(const TrafficClass trafficClass, const uint64_t ns) {
+        std::lock_guard<std::mutex> lock(mutex);
+        deadlines[static_cast<size_t>(trafficClass)] = ns;
+    }
+
+    //Copies one encoded frame into its class queue. Returns false if the frame is malformed or the
+    //queue is full.
+    bool enqueue(const uint8_t *frame, const size_t size, const uint64_t nowNs) {
+        if (size < ProtocolConstants::PROTOCOL_OVERHEAD || size > ProtocolConstants::MAX_FRAME_SIZE ||
+            !ProtocolConstants::isValidHeader(frame[0]) ||
+            size != static_cast<size_t>(frame[1]) + ProtocolConstants::PROTOCOL_OVERHEAD) {
+            LOG(LogLevel::ERROR, "Scheduler rejected malformed frame");
+            return false;
+        }
+        const ProtocolConstants::FrameType type = ProtocolConstants::decodeType(frame[0]);
+        const bool isCommand = type == ProtocolConstants::FrameType::COMMAND && frame[1] >= sizeof(uint16_t);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto c = static_cast<size_t>(classOf[static_cast<size_t>(type)]);
+        std::deque<Pending> &queue = queues[c];
+        ClassStats &s = classStats[c];
+
+        if (isCommand) {
+            const uint16_t commandType = commandTypeOf(frame);
+            for (Pending &pending : queue) {
+                if (pending.type == type && pending.size == size && commandTypeOf(pending.data) == commandType) {
+                    memcpy(pending.data, frame, size);
+                    s.superseded++;
+                    return true;
+                }
+            }
+        }
+        if (queue.size() >= maxQueued) {
+            s.dropped++;
+            return false;
+        }
+
+        Pending pending;
+        pending.enqueuedNs = nowNs;
+        pending.deadlineNs = nowNs + deadlines[c];
+        pending.type = type;
+        pending.size = static_cast<uint8_t>(size);
+        memcpy(pending.data, frame, size);
+        queue.push_back(pending);
+        s.enqueued++;
+        return true;
+    }
+
+    bool enqueue(const uint8_t *frame, const size_t size) {
+        return enqueue(frame, size, nowNs());
+    }
+
+    //Writes the next frames, in dispatch order, into out until the next one would exceed mtu.
+    //Returns bytes written; 0 if nothing is queued or the next frame alone is larger than mtu.
+    size_t nextBatch(uint8_t *out, const size_t mtu, const uint64_t nowNs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t written = 0;
+        for (int c = choose(nowNs); c >= 0; c = choose(nowNs)) {
+            const Pending &head = queues[c].front();
+            if (written + head.size > mtu) {
+                if (written == 0) LOG(LogLevel::ERROR, "MTU smaller than the next frame");
+                break;
+            }
+            memcpy(&out[written], head.data, head.size);
+            written += head.size;
+
+            ClassStats &s = classStats[c];
+            s.sent++;
+            if (nowNs > head.deadlineNs) s.deadlineMisses++;
+            s.latencyNs.counts[LatencyHistogram::bucketOf(nowNs - head.enqueuedNs)]++;
+            s.latencyNs.total++;
+            queues[c].pop_front();
+        }
+        return written;
+    }
+
+    size_t nextBatch(uint8_t *out, const size_t mtu) {
+        return nextBatch(out, mtu, nowNs());
+    }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queues[0].size() + queues[1].size() + queues[2].size();
+    }
+
+    ClassStats stats(const TrafficClass trafficClass) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return classStats[static_cast<size_t>(trafficClass)];
+    }
+};
+
+#endif //SMARTDRIVE_OUTBOUNDSCHEDULER_H
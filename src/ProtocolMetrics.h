@@ -0,0 +1,355 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_PROTOCOLMETRICS_H
+#define SMARTDRIVE_PROTOCOLMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "FrameView.h"
+#include "../Config.h"
+#include "../constants/ProtocolConstants.h"
+
+//Log-linear latency histogram: values below 16 are exact, above that each power of two is split
+//into 16 buckets, so any recorded value is within 6.25% of its bucket's lower bound
+namespace LatencyHistogram {
+    constexpr unsigned SUB_BITS = 4;
+    constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BITS;
+    constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    inline size_t bucketOf(const uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        const unsigned shift = 63 - static_cast<unsigned>(__builtin_clzll(value)) - SUB_BITS;
+        return (shift + 1) * SUB_BUCKETS + static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+    }
+
+    constexpr uint64_t lowerBound(const size_t bucket) {
+        return bucket < SUB_BUCKETS
+                   ? bucket
+                   : (SUB_BUCKETS + bucket % SUB_BUCKETS) << (bucket / SUB_BUCKETS - 1);
+    }
+
+    struct Snapshot {
+        uint64_t counts[BUCKETS] = {};
+        uint64_t total = 0;
+
+        //Lower bound of the bucket holding the p-th percentile (0-100)
+        uint64_t percentile(const double p) const {
+            if (total == 0) return 0;
+            auto rank = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total));
+            if (rank >= total) rank = total - 1;
+            uint64_t seen = 0;
+            for (size_t b = 0; b < BUCKETS; ++b) {
+                seen += counts[b];
+                if (seen > rank) return lowerBound(b);
+            }
+            return 0;
+        }
+
+        uint64_t max() const {
+            for (size_t b = BUCKETS; b-- > 0;) {
+                if (counts[b]) return lowerBound(b);
+            }
+            return 0;
+        }
+    };
+}
+
+//Codec counters kept per thread in their own cache lines and summed only when a snapshot is
+//taken. The owning thread updates its counters with a plain load + store (no locked instruction);
+//readers may see a snapshot that is a few operations behind. Encode/decode latency is timed on one
+//operation in METRICS_LATENCY_SAMPLE_EVERY so the clock reads stay off most calls.
+//With METRICS_ENABLED 0 every hook is an empty inline function.
+namespace ProtocolMetrics {
+    constexpr size_t TYPES = ProtocolConstants::MAX_FRAME_TYPES;
+    constexpr size_t REJECT_REASONS = static_cast<size_t>(FrameStatus::MALFORMED_PAYLOAD) + 1;
+
+    enum class Operation : uint8_t {
+        ENCODE,
+        DECODE
+    };
+
+    struct Snapshot {
+        uint64_t framesEncoded[TYPES] = {};
+        uint64_t bytesEncoded[TYPES] = {};
+        uint64_t framesDecoded[TYPES] = {};
+        uint64_t bytesDecoded[TYPES] = {};
+        uint64_t rejects[REJECT_REASONS] = {}; //indexed by FrameStatus; OK is unused
+        uint64_t resyncBytes = 0;
+        LatencyHistogram::Snapshot encodeLatencyNs;
+        LatencyHistogram::Snapshot decodeLatencyNs;
+    };
+
+    namespace detail {
+        using Counter = std::atomic<uint64_t>;
+
+        inline void bump(Counter &counter, const uint64_t amount) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        struct alignas(64) ThreadMetrics {
+            Counter framesEncoded[TYPES] = {};
+            Counter bytesEncoded[TYPES] = {};
+            Counter framesDecoded[TYPES] = {};
+            Counter bytesDecoded[TYPES] = {};
+            Counter rejects[REJECT_REASONS] = {};
+            Counter resyncBytes{0};
+            Counter encodeLatency[LatencyHistogram::BUCKETS] = {};
+            Counter decodeLatency[LatencyHistogram::BUCKETS] = {};
+            uint32_t sampleTick[2] = {}; //per Operation, owner thread only
+
+            void addTo(Snapshot &s) const {
+                for (size_t t = 0; t < TYPES; ++t) {
+                    s.framesEncoded[t] += framesEncoded[t].load(std::memory_order_relaxed);
+                    s.bytesEncoded[t] += bytesEncoded[t].load(std::memory_order_relaxed);
+                    s.framesDecoded[t] += framesDecoded[t].load(std::memory_order_relaxed);
+                    s.bytesDecoded[t] += bytesDecoded[t].load(std::memory_order_relaxed);
+                }
+                for (size_t r = 0; r < REJECT_REASONS; ++r) {
+                    s.rejects[r] += rejects[r].load(std::memory_order_relaxed);
+                }
+                s.resyncBytes += resyncBytes.load(std::memory_order_relaxed);
+                for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                    const uint64_t e = encodeLatency[b].load(std::memory_order_relaxed);
+                    const uint64_t d = decodeLatency[b].load(std::memory_order_relaxed);
+                    s.encodeLatencyNs.counts[b] += e;
+                    s.encodeLatencyNs.total += e;
+                    s.decodeLatencyNs.counts[b] += d;
+                    s.decodeLatencyNs.total += d;
+                }
+            }
+
+            void clear() {
+                for (Counter *range : {framesEncoded, bytesEncoded, framesDecoded, bytesDecoded}) {
+                    for (size_t t = 0; t < TYPES; ++t) range[t].store(0, std::memory_order_relaxed);
+                }
+                for (Counter &c : rejects) c.store(0, std::memory_order_relaxed);
+                resyncBytes.store(0, std::memory_order_relaxed);
+                for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                    encodeLatency[b].store(0, std::memory_order_relaxed);
+                    decodeLatency[b].store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        //Live per-thread blocks plus the folded totals of threads that have exited
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadMetrics> > live;
+            Snapshot retired;
+
+            static Registry &instance() {
+                static Registry registry;
+                return registry;
+            }
+        };
+
+        struct ThreadHandle {
+            std::shared_ptr<ThreadMetrics> metrics;
+
+            ThreadHandle() : metrics(std::make_shared<ThreadMetrics>()) {
+                Registry &registry = Registry::instance();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.live.push_back(metrics);
+            }
+
+            ~ThreadHandle() {
+                Registry &registry = Registry::instance();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                metrics->addTo(registry.retired);
+                for (size_t i = 0; i < registry.live.size(); ++i) {
+                    if (registry.live[i] == metrics) {
+                        registry.live[i] = registry.live.back();
+                        registry.live.pop_back();
+                        break;
+                    }
+                }
+            }
+        };
+
+        inline ThreadMetrics &registerThread() {
+            thread_local ThreadHandle handle;
+            return *handle.metrics;
+        }
+
+        //The plain pointer needs no TLS guard check, unlike the handle; only the first call per thread registers
+        inline ThreadMetrics &local() {
+            thread_local ThreadMetrics *metrics = nullptr;
+            if (__builtin_expect(metrics == nullptr, 0)) metrics = &registerThread();
+            return *metrics;
+        }
+
+        inline uint64_t nowNs() {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+    }
+
+#if METRICS_ENABLED
+    inline void frameEncoded(const ProtocolConstants::FrameType type, const size_t bytes, const size_t frames = 1) {
+        detail::ThreadMetrics &m = detail::local();
+        detail::bump(m.framesEncoded[static_cast<size_t>(type)], frames);
+        detail::bump(m.bytesEncoded[static_cast<size_t>(type)], bytes);
+    }
+
+    inline void frameDecoded(const ProtocolConstants::FrameType type, const size_t bytes, const size_t frames = 1) {
+        detail::ThreadMetrics &m = detail::local();
+        detail::bump(m.framesDecoded[static_cast<size_t>(type)], frames);
+        detail::bump(m.bytesDecoded[static_cast<size_t>(type)], bytes);
+    }
+
+    inline void frameRejected(const FrameStatus reason) {
+        const auto index = static_cast<size_t>(reason);
+        if (index < REJECT_REASONS) detail::bump(detail::local().rejects[index], 1);
+    }
+
+    inline void resyncBytes(const size_t bytes) {
+        detail::bump(detail::local().resyncBytes, bytes);
+    }
+
+    //Times the enclosing scope if this call is the thread's sampled one
+    class LatencyTimer {
+    private:
+        detail::ThreadMetrics &metrics;
+        uint64_t start = 0;
+        Operation operation;
+
+    public:
+        explicit LatencyTimer(const Operation operation) : metrics(detail::local()), operation(operation) {
+            if (++metrics.sampleTick[static_cast<size_t>(operation)] % METRICS_LATENCY_SAMPLE_EVERY == 0) start = detail::nowNs();
+        }
+
+        LatencyTimer(const LatencyTimer &) = delete;
+        LatencyTimer &operator=(const LatencyTimer &) = delete;
+
+        ~LatencyTimer() {
+            if (start == 0) return;
+            const size_t bucket = LatencyHistogram::bucketOf(detail::nowNs() - start);
+            detail::bump(operation == Operation::ENCODE ? metrics.encodeLatency[bucket] : metrics.decodeLatency[bucket], 1);
+        }
+    };
+#else
+    inline void frameEncoded(ProtocolConstants::FrameType, size_t, size_t = 1) {
+    }
+    inline void frameDecoded(ProtocolConstants::FrameType, size_t, size_t = 1) {
+    }
+    inline void frameRejected(FrameStatus) {
+    }
+    inline void resyncBytes(size_t) {
+    }
+
+    class LatencyTimer {
+    public:
+        explicit LatencyTimer(Operation) {
+        }
+    };
+#endif
+
+    inline Snapshot snapshot() {
+        Snapshot s;
+        detail::Registry &registry = detail::Registry::instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        s = registry.retired;
+        for (const std::shared_ptr<detail::ThreadMetrics> &m : registry.live) m->addTo(s);
+        return s;
+    }
+
+    //Only exact while no other thread is encoding or decoding
+    inline void reset() {
+        detail::Registry &registry = detail::Registry::instance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired = Snapshot();
+        for (const std::shared_ptr<detail::ThreadMetrics> &m : registry.live) m->clear();
+    }
+
+    inline const char *rejectName(const size_t reason) {
+        switch (static_cast<FrameStatus>(reason)) {
+            case FrameStatus::TOO_SMALL: return "too_small";
+            case FrameStatus::INVALID_HEADER: return "invalid_header";
+            case FrameStatus::TYPE_MISMATCH: return "type_mismatch";
+            case FrameStatus::INVALID_SIZE: return "invalid_size";
+            case FrameStatus::PAYLOAD_SIZE_MISMATCH: return "payload_size_mismatch";
+            case FrameStatus::CRC_MISMATCH: return "crc_mismatch";
+            case FrameStatus::MALFORMED_PAYLOAD: return "malformed_payload";
+            default: return "ok";
+        }
+    }
+
+    enum class Format : uint8_t {
+        TEXT,
+        JSON
+    };
+
+    inline std::string format(const Snapshot &s, const Format fmt) {
+        std::string out;
+        char line[256];
+        const bool json = fmt == Format::JSON;
+        const auto append = [&](const int n) { out.append(line, n > 0 ? static_cast<size_t>(n) : 0); };
+
+        append(snprintf(line, sizeof(line), json ? "{\n  \"types\": [\n" : "type  enc_frames  enc_bytes  dec_frames  dec_bytes\n"));
+        for (size_t t = 0; t < TYPES; ++t) {
+            append(snprintf(line, sizeof(line),
+                            json ? "    {\"type\": %zu, \"frames_encoded\": %llu, \"bytes_encoded\": %llu, "
+                                   "\"frames_decoded\": %llu, \"bytes_decoded\": %llu}%s\n"
+                                 : "%4zu  %10llu  %9llu  %10llu  %9llu%s\n",
+                            t, static_cast<unsigned long long>(s.framesEncoded[t]),
+                            static_cast<unsigned long long>(s.bytesEncoded[t]),
+                            static_cast<unsigned long long>(s.framesDecoded[t]),
+                            static_cast<unsigned long long>(s.bytesDecoded[t]),
+                            json && t + 1 < TYPES ? "," : ""));
+        }
+        append(snprintf(line, sizeof(line), json ? "  ],\n  \"rejects\": {" : "rejects:"));
+        for (size_t r = 1; r < REJECT_REASONS; ++r) {
+            append(snprintf(line, sizeof(line), json ? "%s\"%s\": %llu" : "%s%s=%llu",
+                            r > 1 && json ? ", " : " ", rejectName(r), static_cast<unsigned long long>(s.rejects[r])));
+        }
+        append(snprintf(line, sizeof(line), json ? "},\n  \"resync_bytes\": %llu,\n" : "\nresync_bytes: %llu\n",
+                        static_cast<unsigned long long>(s.resyncBytes)));
+
+        const LatencyHistogram::Snapshot *histograms[] = {&s.encodeLatencyNs, &s.decodeLatencyNs};
+        const char *names[] = {"encode_latency_ns", "decode_latency_ns"};
+        for (size_t h = 0; h < 2; ++h) {
+            const LatencyHistogram::Snapshot &hist = *histograms[h];
+            append(snprintf(line, sizeof(line),
+                            json ? "  \"%s\": {\"samples\": %llu, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, "
+                                   "\"p999\": %llu, \"max\": %llu}%s\n"
+                                 : "%s: samples=%llu p50=%llu p90=%llu p99=%llu p99.9=%llu max=%llu%s\n",
+                            names[h], static_cast<unsigned long long>(hist.total),
+                            static_cast<unsigned long long>(hist.percentile(50)),
+                            static_cast<unsigned long long>(hist.percentile(90)),
+                            static_cast<unsigned long long>(hist.percentile(99)),
+                            static_cast<unsigned long long>(hist.percentile(99.9)),
+                            static_cast<unsigned long long>(hist.max()), json && h == 0 ? "," : ""));
+        }
+        if (json) out += "}\n";
+        return out;
+    }
+
+    //Writes a snapshot next to path and renames it into place, so a scraper polling the file
+    //never reads a partial dump
+    inline bool dumpToFile(const char *path, const Format fmt) {
+        const std::string text = format(snapshot(), fmt);
+        const std::string temporary = std::string(path) + ".tmp";
+        FILE *file = fopen(temporary.c_str(), "w");
+        if (!file) {
+            LOG(LogLevel::ERROR, "Metrics file could not be opened");
+            return false;
+        }
+        const bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+        if (fclose(file) != 0 || !ok || rename(temporary.c_str(), path) != 0) {
+            LOG(LogLevel::ERROR, "Metrics file could not be written");
+            return false;
+        }
+        return true;
+    }
+}
+
+#endif //SMARTDRIVE_PROTOCOLMETRICS_H
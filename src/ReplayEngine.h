@@ -0,0 +1,234 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_REPLAYENGINE_H
+#define SMARTDRIVE_REPLAYENGINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CaptureFile.h"
+#include "FrameStreamDecoder.h"
+#include "FrameView.h"
+#include "../constants/ProtocolConstants.h"
+#include "../utils/Logger.h"
+
+enum class ReplayPacing : uint8_t {
+    AS_FAST_AS_POSSIBLE,
+    ORIGINAL //honour the recorded gaps, scaled by Options::speed
+};
+
+//Feeds a capture back through the same FrameHandler table a FrameStreamDecoder uses. Frames are
+//CRC-checked with FrameView before dispatch. With several workers the capture is processed in rounds
+//of one segment per worker: each worker scans its own segment once and sorts the records by link
+//(linkId % workers) into per-worker lists, then every worker dispatches its links' records from
+//those segments in file order. The file is scanned once in total and each link keeps its recorded
+//order; handlers shared by links on different workers must be thread-safe. Records are referenced
+//in place in each worker's read-only mapping, never copied.
+class ReplayEngine {
+public:
+    struct Options {
+        ReplayPacing pacing = ReplayPacing::AS_FAST_AS_POSSIBLE;
+        double speed = 1.0;
+        unsigned workers = 1;
+        uint64_t startNs = 0;
+        uint64_t endNs = UINT64_MAX;
+    };
+
+    //Time from dispatch to handler return, including the CRC check
+    struct TypeStats {
+        uint64_t frames = 0;
+        uint64_t totalNs = 0;
+        uint64_t maxNs = 0;
+
+        double meanNs() const { return frames ? static_cast<double>(totalNs) / static_cast<double>(frames) : 0.0; }
+    };
+
+    struct Report {
+        uint64_t frames = 0;
+        uint64_t bytes = 0;
+        uint64_t invalid = 0;
+        uint64_t unhandled = 0;
+        uint64_t segmentsSkipped = 0; //a worker could not open the capture or seek to the segment
+        double seconds = 0.0;
+        TypeStats types[ProtocolConstants::MAX_FRAME_TYPES];
+
+        double framesPerSecond() const { return seconds > 0.0 ? static_cast<double>(frames) / seconds : 0.0; }
+        double bytesPerSecond() const { return seconds > 0.0 ? static_cast<double>(bytes) / seconds : 0.0; }
+    };
+
+private:
+    struct HandlerEntry {
+        FrameHandler handler = nullptr;
+        void *context = nullptr;
+    };
+
+    HandlerEntry handlers[ProtocolConstants::MAX_FRAME_TYPES];
+
+    //Cyclic rendezvous for the scan and dispatch phases of each round
+    class Barrier {
+        std::mutex mutex;
+        std::condition_variable released;
+        const unsigned count;
+        unsigned waiting = 0;
+        uint64_t generation = 0;
+
+    public:
+        explicit Barrier(const unsigned count) : count(count) {
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            const uint64_t arrived = generation;
+            if (++waiting == count) {
+                waiting = 0;
+                generation++;
+                released.notify_all();
+            } else {
+                released.wait(lock, [this, arrived] { return generation != arrived; });
+            }
+        }
+    };
+
+    //records[source][destination]: what worker source found in its segment for worker destination's links
+    using Partition = std::vector<std::vector<std::vector<CaptureRecord> > >;
+
+    struct Run {
+        const char *path;
+        Options options;
+        size_t firstSegment;
+        size_t endSegment;
+        uint64_t firstNs;
+        std::chrono::steady_clock::time_point start;
+        Barrier barrier;
+        Partition records;
+
+        Run(const char *path, const Options &options, const size_t firstSegment, const size_t endSegment,
+            const uint64_t firstNs)
+            : path(path), options(options), firstSegment(firstSegment), endSegment(endSegment), firstNs(firstNs),
+              start(std::chrono::steady_clock::now()), barrier(options.workers),
+              records(options.workers, std::vector<std::vector<CaptureRecord> >(options.workers)) {
+        }
+    };
+
+    void dispatch(const CaptureRecord &record, const Run &run, Report &report) const {
+        using Clock = std::chrono::steady_clock;
+        if (run.options.pacing == ReplayPacing::ORIGINAL) {
+            const double offsetNs = static_cast<double>(record.timestampNs - run.firstNs) / run.options.speed;
+            std::this_thread::sleep_until(run.start + std::chrono::nanoseconds(static_cast<int64_t>(offsetNs)));
+        }
+
+        report.frames++;
+        report.bytes += record.size;
+        const Clock::time_point t0 = Clock::now();
+        if (FrameView::validate(record.frame, record.size) != FrameStatus::OK) {
+            report.invalid++;
+            return;
+        }
+        const auto type = static_cast<size_t>(ProtocolConstants::decodeType(record.frame[0]));
+        const HandlerEntry &entry = handlers[type];
+        if (!entry.handler) {
+            report.unhandled++;
+            return;
+        }
+        entry.handler(entry.context, record.frame, record.size);
+
+        const auto elapsed = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+        TypeStats &stats = report.types[type];
+        stats.frames++;
+        stats.totalNs += elapsed;
+        if (elapsed > stats.maxNs) stats.maxNs = elapsed;
+    }
+
+    void replayWorker(Run &run, const unsigned index, Report &report) const {
+        const unsigned workers = run.options.workers;
+        CaptureReader reader;
+        const bool opened = reader.open(run.path);
+
+        for (size_t round = run.firstSegment; round < run.endSegment; round += workers) {
+            std::vector<std::vector<CaptureRecord> > &found = run.records[index];
+            for (std::vector<CaptureRecord> &list : found) list.clear();
+
+            const size_t segment = round + index;
+            if (segment < run.endSegment) {
+                if (opened && reader.seekSegment(segment)) {
+                    CaptureRecord record{};
+                    while (reader.next(record) && reader.segment() == segment) {
+                        if (record.timestampNs < run.options.startNs || record.timestampNs > run.options.endNs) continue;
+                        found[record.linkId % workers].push_back(record);
+                    }
+                } else {
+                    report.segmentsSkipped++;
+                    LOG(LogLevel::ERROR, "Replay worker could not read its capture segment");
+                }
+            }
+            run.barrier.wait();
+
+            for (unsigned source = 0; source < workers; ++source) {
+                for (const CaptureRecord &record : run.records[source][index]) dispatch(record, run, report);
+            }
+            run.barrier.wait();
+        }
+    }
+
+public:
+    void setHandler(const ProtocolConstants::FrameType type, const FrameHandler handler, void *context = nullptr) {
+        handlers[static_cast<uint8_t>(type)] = {handler, context};
+    }
+
+    //Blocks until the whole range has been replayed. Returns false if the capture cannot be opened or
+    //a worker had to skip segments (Report::segmentsSkipped), in which case out is incomplete.
+    bool run(const char *path, Options options, Report &out) const {
+        out = Report();
+        if (options.workers == 0) options.workers = 1;
+        if (options.speed <= 0.0) options.speed = 1.0;
+
+        CaptureReader reader;
+        CaptureRecord first{};
+        if (!reader.open(path)) return false;
+        if (!reader.seek(options.startNs) || !reader.next(first)) return true;
+        const size_t firstSegment = reader.segment();
+        size_t endSegment = reader.segmentCount();
+        if (options.endNs < UINT64_MAX && reader.seek(options.endNs + 1)) endSegment = reader.segment() + 1;
+        reader.close();
+
+        if (options.workers > endSegment - firstSegment) {
+            options.workers = static_cast<unsigned>(endSegment - firstSegment);
+        }
+        Run run(path, options, firstSegment, endSegment, first.timestampNs);
+        std::vector<Report> reports(options.workers);
+        if (options.workers == 1) {
+            replayWorker(run, 0, reports[0]);
+        } else {
+            std::vector<std::thread> threads;
+            for (unsigned i = 0; i < options.workers; ++i) {
+                threads.emplace_back(&ReplayEngine::replayWorker, this, std::ref(run), i, std::ref(reports[i]));
+            }
+            for (std::thread &t : threads) t.join();
+        }
+        out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run.start).count();
+
+        for (const Report &r : reports) {
+            out.frames += r.frames;
+            out.bytes += r.bytes;
+            out.invalid += r.invalid;
+            out.unhandled += r.unhandled;
+            out.segmentsSkipped += r.segmentsSkipped;
+            for (size_t t = 0; t < ProtocolConstants::MAX_FRAME_TYPES; ++t) {
+                out.types[t].frames += r.types[t].frames;
+                out.types[t].totalNs += r.types[t].totalNs;
+                if (r.types[t].maxNs > out.types[t].maxNs) out.types[t].maxNs = r.types[t].maxNs;
+            }
+        }
+        return out.segmentsSkipped == 0;
+    }
+};
+
+#endif //SMARTDRIVE_REPLAYENGINE_H
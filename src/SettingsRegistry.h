@@ -0,0 +1,266 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_SETTINGSREGISTRY_H
+#define SMARTDRIVE_SETTINGSREGISTRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CompactCodec.h"
+#include "FrameView.h"
+#include "../types/RobotData.h"
+
+//One immutable version of every known setting, in a flat open-addressing table (linear probing,
+//power-of-two capacity, at most half full). Each entry remembers the version that last changed it,
+//which is all a diff needs.
+class SettingsSnapshot {
+public:
+    struct Entry {
+        SettingsData value;
+        uint64_t changedVersion;
+        bool used;
+    };
+
+private:
+    friend class SettingsRegistry;
+
+    uint64_t versionNumber = 0;
+    size_t entryCount = 0;
+    size_t mask = 0;
+    std::unique_ptr<Entry[]> entries;
+
+    static size_t slotOf(const uint16_t settingsID, const size_t mask) {
+        //Fibonacci hashing spreads sequential IDs across the table
+        return (static_cast<uint32_t>(settingsID) * 2654435769u >> 16) & mask;
+    }
+
+    explicit SettingsSnapshot(const size_t capacity) : mask(capacity - 1), entries(new Entry[capacity]()) {
+    }
+
+    Entry *slotFor(const uint16_t settingsID) const {
+        for (size_t i = slotOf(settingsID, mask);; i = (i + 1) & mask) {
+            Entry &entry = entries[i];
+            if (!entry.used || entry.value.settingsID == settingsID) return &entry;
+        }
+    }
+
+public:
+    uint64_t version() const { return versionNumber; }
+    size_t size() const { return entryCount; }
+
+    const SettingsData *find(const uint16_t settingsID) const {
+        const Entry *entry = slotFor(settingsID);
+        return entry->used ? &entry->value : nullptr;
+    }
+
+    //Settings changed after sinceVersion, in table order. Returns how many were written to out
+    //(up to max); total receives the full count so a caller can size a second pass.
+    size_t diff(const uint64_t sinceVersion, SettingsData *out, const size_t max, size_t *total = nullptr) const {
+        size_t written = 0, changed = 0;
+        for (size_t i = 0; i <= mask; ++i) {
+            const Entry &entry = entries[i];
+            if (!entry.used || entry.changedVersion <= sinceVersion) continue;
+            if (written < max) out[written++] = entry.value;
+            changed++;
+        }
+        if (total) *total = changed;
+        return written;
+    }
+
+    template<typename Visitor>
+    void forEach(Visitor &&visit) const {
+        for (size_t i = 0; i <= mask; ++i) {
+            if (entries[i].used) visit(entries[i].value, entries[i].changedVersion);
+        }
+    }
+};
+
+//Settings keyed by settingsID. Readers pin the current SettingsSnapshot without locks; writers build
+//the next snapshot off to the side and publish it with one pointer swap, so a burst of updates
+//becomes visible all at once. A replaced snapshot is freed only after every reader that could
+//still see it has finished (epoch-based grace period).
+class SettingsRegistry {
+public:
+    static constexpr size_t READER_SLOTS = 64;
+
+    //Updates applied together by commit()
+    class Batch {
+    private:
+        friend class SettingsRegistry;
+        std::vector<SettingsData> updates;
+
+    public:
+        void set(const SettingsData &setting) { updates.push_back(setting); }
+
+        //Decodes one SETTINGS frame, fixed or compact, into the batch
+        FrameStatus addFrame(const uint8_t *frame, const size_t size) {
+            SettingsData setting{};
+            const FrameStatus status = CompactCodec::deserialize(frame, size, setting);
+            if (status == FrameStatus::OK) updates.push_back(setting);
+            return status;
+        }
+
+        size_t size() const { return updates.size(); }
+        void clear() { updates.clear(); }
+    };
+
+    //Keeps one snapshot alive for the guard's lifetime
+    class ReadGuard {
+    private:
+        friend class SettingsRegistry;
+        std::atomic<uint64_t> *slot;
+        const SettingsSnapshot *pinned;
+
+        ReadGuard(std::atomic<uint64_t> *slot, const SettingsSnapshot *snapshot) : slot(slot), pinned(snapshot) {
+        }
+
+    public:
+        ReadGuard(ReadGuard &&other) noexcept : slot(other.slot), pinned(other.pinned) {
+            other.slot = nullptr;
+        }
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+        ReadGuard &operator=(ReadGuard &&) = delete;
+
+        ~ReadGuard() {
+            if (slot) slot->store(0, std::memory_order_release);
+        }
+
+        const SettingsSnapshot &operator*() const { return *pinned; }
+        const SettingsSnapshot *operator->() const { return pinned; }
+    };
+
+private:
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0}; //0 = not reading
+    };
+
+    struct Retired {
+        const SettingsSnapshot *snapshot;
+        uint64_t epoch;
+    };
+
+    std::atomic<const SettingsSnapshot *> current;
+    std::atomic<uint64_t> globalEpoch{1};
+    ReaderSlot readers[READER_SLOTS];
+    std::mutex writerMutex;
+    std::vector<Retired> retired;
+
+    static SettingsSnapshot *copyWithCapacity(const SettingsSnapshot &from, const size_t capacity) {
+        auto *next = new SettingsSnapshot(capacity);
+        next->entryCount = from.entryCount;
+        for (size_t i = 0; i <= from.mask; ++i) {
+            if (from.entries[i].used) *next->slotFor(from.entries[i].value.settingsID) = from.entries[i];
+        }
+        return next;
+    }
+
+    static bool sameValue(const SettingsData &a, const SettingsData &b) {
+        return memcmp(static_cast<const ValueSource *>(&a), static_cast<const ValueSource *>(&b), sizeof(ValueSource)) == 0;
+    }
+
+    //Frees every retired snapshot no active reader can still hold; caller holds writerMutex
+    void reclaim() {
+        uint64_t oldest = UINT64_MAX;
+        for (const ReaderSlot &reader : readers) {
+            const uint64_t epoch = reader.epoch.load(std::memory_order_seq_cst);
+            if (epoch != 0 && epoch < oldest) oldest = epoch;
+        }
+        for (size_t i = 0; i < retired.size();) {
+            if (retired[i].epoch <= oldest) {
+                delete retired[i].snapshot;
+                retired[i] = retired.back();
+                retired.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+public:
+    SettingsRegistry() : current(new SettingsSnapshot(16)) {
+    }
+
+    SettingsRegistry(const SettingsRegistry &) = delete;
+    SettingsRegistry &operator=(const SettingsRegistry &) = delete;
+
+    ~SettingsRegistry() {
+        for (const Retired &r : retired) delete r.snapshot;
+        delete current.load();
+    }
+
+    //Pins the current snapshot. Lock-free: it only claims a reader slot, and waits only if
+    //READER_SLOTS guards are already held at once.
+    ReadGuard read() {
+        const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+        for (size_t i = 0;; ++i) {
+            std::atomic<uint64_t> &slot = readers[(start + i) % READER_SLOTS].epoch;
+            uint64_t expected = 0;
+            if (slot.load(std::memory_order_relaxed) == 0 &&
+                slot.compare_exchange_strong(expected, globalEpoch.load(std::memory_order_seq_cst),
+                                             std::memory_order_seq_cst)) {
+                return ReadGuard(&slot, current.load(std::memory_order_seq_cst));
+            }
+            if (i % READER_SLOTS == READER_SLOTS - 1) std::this_thread::yield();
+        }
+    }
+
+    uint64_t version() const { return current.load(std::memory_order_acquire)->version(); }
+
+    //Applies every update in batch as one new version (later updates to the same settingsID win).
+    //Returns the new version, or the current one if nothing actually changed.
+    uint64_t commit(const Batch &batch) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        const SettingsSnapshot *previous = current.load(std::memory_order_relaxed);
+
+        size_t capacity = previous->mask + 1;
+        while ((previous->entryCount + batch.updates.size()) * 2 > capacity) capacity *= 2;
+        std::unique_ptr<SettingsSnapshot> next(copyWithCapacity(*previous, capacity));
+        next->versionNumber = previous->versionNumber + 1;
+
+        bool changed = false;
+        for (const SettingsData &update : batch.updates) {
+            SettingsSnapshot::Entry *entry = next->slotFor(update.settingsID);
+            if (entry->used && sameValue(entry->value, update)) continue;
+            if (!entry->used) {
+                entry->used = true;
+                next->entryCount++;
+            }
+            entry->value = update;
+            entry->changedVersion = next->versionNumber;
+            changed = true;
+        }
+        if (!changed) return previous->versionNumber;
+
+        const uint64_t version = next->versionNumber;
+        current.store(next.release(), std::memory_order_seq_cst);
+        //Readers that announced an epoch before this increment may still hold previous
+        retired.push_back({previous, globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1});
+        reclaim();
+        return version;
+    }
+
+    uint64_t set(const SettingsData &setting) {
+        Batch batch;
+        batch.set(setting);
+        return commit(batch);
+    }
+
+    //Snapshots replaced but not yet freed because a reader may still hold them
+    size_t pendingReclaim() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        reclaim();
+        return retired.size();
+    }
+};
+
+#endif //SMARTDRIVE_SETTINGSREGISTRY_H
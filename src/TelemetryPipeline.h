@@ -0,0 +1,240 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_TELEMETRYPIPELINE_H
+#define SMARTDRIVE_TELEMETRYPIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "CompactCodec.h"
+#include "FrameCodec.h"
+#include "FrameView.h"
+#include "../types/RobotData.h"
+#include "../utils/FrameRing.h"
+
+//Invoked on a worker thread. Calls for one sourceID never overlap and arrive in submit order.
+using TelemetryHandler = void (*)(void *context, const TelemetryData &telemetry);
+
+//Spreads decode and handling of TELEMETRY frames from many links over a worker pool.
+//Frames are sharded by sourceID into MPSC rings; a shard is only ever drained by one worker at a
+//time, which keeps every source in order. Each worker owns a set of home shards and, when those
+//are empty, drains any other non-empty shard that no worker holds at that moment, whether or not
+//its owner is busy, so a busy worker's other shards are not left waiting. A single sourceID is
+//still handled by one worker at a time.
+template<size_t ShardCount = 64, size_t ShardCapacity = 256>
+class TelemetryPipeline {
+    static_assert((ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+public:
+    struct Stats {
+        //Ingest stage
+        uint64_t submitted = 0;
+        uint64_t rejected = 0; //not a TELEMETRY frame of the right size
+        uint64_t dropped = 0; //shard queue full
+        //Decode + handler stage
+        uint64_t decoded = 0;
+        uint64_t decodeErrors = 0;
+        uint64_t steals = 0;
+        size_t queueDepth = 0;
+        size_t maxShardDepth = 0;
+        double secondsRunning = 0.0;
+    };
+
+    static constexpr size_t BATCH_SIZE = 32;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        MpscFrameRing<ShardCapacity> ring;
+        alignas(CACHE_LINE_SIZE) std::atomic<bool> busy{false};
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    struct alignas(CACHE_LINE_SIZE) WorkerCounters {
+        std::atomic<uint64_t> decoded{0};
+        std::atomic<uint64_t> decodeErrors{0};
+        std::atomic<uint64_t> steals{0};
+    };
+
+    TelemetryHandler handler;
+    void *handlerContext;
+    unsigned workerCount;
+
+    std::unique_ptr<Shard[]> shards;
+    std::unique_ptr<WorkerCounters[]> counters;
+    std::vector<std::thread> workers;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> rejected{0};
+    std::atomic<bool> accepting{false};
+    std::atomic<bool> stopping{false};
+    std::chrono::steady_clock::time_point startTime;
+
+    //Drains one batch from a shard if no other worker holds it. Returns frames processed.
+    size_t drain(Shard &shard, WorkerCounters &local) {
+        if (shard.ring.size() == 0 || shard.busy.exchange(true, std::memory_order_acquire)) {
+            return 0;
+        }
+
+        uint64_t decoded = 0;
+        uint64_t errors = 0;
+        const size_t processed = shard.ring.consume([&](const FrameSlot &slot) {
+            TelemetryData telemetry;
+            if (CompactCodec::deserialize(slot.data, slot.size, telemetry) != FrameStatus::OK) {
+                errors++;
+                return;
+            }
+            decoded++;
+            handler(handlerContext, telemetry);
+        }, BATCH_SIZE);
+
+        shard.busy.store(false, std::memory_order_release);
+
+        local.decoded.fetch_add(decoded, std::memory_order_relaxed);
+        local.decodeErrors.fetch_add(errors, std::memory_order_relaxed);
+        return processed;
+    }
+
+    bool allShardsEmpty() const {
+        for (size_t i = 0; i < ShardCount; ++i) {
+            if (shards[i].ring.size() != 0) return false;
+        }
+        return true;
+    }
+
+    void workerLoop(const unsigned index) {
+        WorkerCounters &local = counters[index];
+        unsigned idleRounds = 0;
+
+        for (;;) {
+            size_t processed = 0;
+            for (size_t s = index; s < ShardCount; s += workerCount) {
+                processed += drain(shards[s], local);
+            }
+
+            if (processed == 0) {
+                //Home shards are empty: help with any other shard that has a backlog and is not held
+                for (size_t i = 1; i < ShardCount; ++i) {
+                    const size_t s = (index + i) % ShardCount;
+                    if (s % workerCount == index) continue;
+                    const size_t stolen = drain(shards[s], local);
+                    if (stolen > 0) {
+                        local.steals.fetch_add(1, std::memory_order_relaxed);
+                        processed += stolen;
+                    }
+                }
+            }
+
+            if (processed > 0) {
+                idleRounds = 0;
+                continue;
+            }
+            if (stopping.load(std::memory_order_acquire) && allShardsEmpty()) {
+                return;
+            }
+            if (++idleRounds < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+public:
+    static size_t shardOf(const uint16_t sourceID) {
+        return (static_cast<uint32_t>(sourceID) * 2654435761u >> 16) & (ShardCount - 1);
+    }
+
+    TelemetryPipeline(const unsigned workers, const TelemetryHandler handler, void *context = nullptr)
+        : handler(handler), handlerContext(context), workerCount(workers > 0 ? workers : 1),
+          shards(new Shard[ShardCount]), counters(new WorkerCounters[workerCount]) {
+    }
+
+    TelemetryPipeline(const TelemetryPipeline &) = delete;
+    TelemetryPipeline &operator=(const TelemetryPipeline &) = delete;
+
+    ~TelemetryPipeline() {
+        stop();
+    }
+
+    void start() {
+        if (!workers.empty()) return;
+        stopping.store(false, std::memory_order_relaxed);
+        startTime = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&TelemetryPipeline::workerLoop, this, i);
+        }
+        accepting.store(true, std::memory_order_release);
+    }
+
+    //Stops accepting frames, lets the workers finish everything already queued, then joins them.
+    //Link threads should have stopped calling submit() before this is called.
+    void stop() {
+        accepting.store(false, std::memory_order_release);
+        stopping.store(true, std::memory_order_release);
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    //Thread-safe; called by any number of link reader threads. The frame is copied into its shard.
+    bool submit(const uint8_t *frame, const size_t size) {
+        if (!accepting.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        //Only the header and the sourceID are peeked here; CRC checking is part of the decode stage.
+        //Fixed and compact frames both end their payload with sourceID(2) + timestamp(4).
+        constexpr size_t trailerSize = CompactCodec::Trailer<TelemetryData>::size;
+        if (size < ProtocolConstants::PROTOCOL_OVERHEAD + 1 + trailerSize ||
+            size > FrameCodec::frameSize<TelemetryData> ||
+            size != static_cast<size_t>(frame[1]) + ProtocolConstants::PROTOCOL_OVERHEAD ||
+            !ProtocolConstants::isValidHeader(frame[0]) ||
+            ProtocolConstants::decodeType(frame[0]) != ProtocolConstants::FrameType::TELEMETRY) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        const uint16_t sourceID = ByteOrder::readUint16LE(&frame[ProtocolConstants::HEADER_SIZE + frame[1] - trailerSize]);
+        Shard &shard = shards[shardOf(sourceID)];
+        if (!shard.ring.tryPush(frame, size)) {
+            shard.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        shard.submitted.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t queueDepth(const size_t shard) const {
+        return shards[shard].ring.size();
+    }
+
+    //Aggregated on read; the hot paths only touch their own shard or worker counters
+    Stats stats() const {
+        Stats s;
+        s.rejected = rejected.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < ShardCount; ++i) {
+            s.submitted += shards[i].submitted.load(std::memory_order_relaxed);
+            s.dropped += shards[i].dropped.load(std::memory_order_relaxed);
+            const size_t depth = shards[i].ring.size();
+            s.queueDepth += depth;
+            if (depth > s.maxShardDepth) s.maxShardDepth = depth;
+        }
+        for (unsigned i = 0; i < workerCount; ++i) {
+            s.decoded += counters[i].decoded.load(std::memory_order_relaxed);
+            s.decodeErrors += counters[i].decodeErrors.load(std::memory_order_relaxed);
+            s.steals += counters[i].steals.load(std::memory_order_relaxed);
+        }
+        s.secondsRunning = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return s;
+    }
+
+    unsigned workersRunning() const { return static_cast<unsigned>(workers.size()); }
+};
+
+#endif //SMARTDRIVE_TELEMETRYPIPELINE_H
@@ -0,0 +1,360 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_TELEMETRYSTORE_H
+#define SMARTDRIVE_TELEMETRYSTORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "../types/RobotData.h"
+#include "../types/ValueSource.h"
+
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
+struct TelemetryAggregate {
+    uint64_t count = 0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0.0;
+
+    double mean() const { return count ? sum / static_cast<double>(count) : 0.0; }
+
+    void merge(const TelemetryAggregate &other) {
+        count += other.count;
+        sum += other.sum;
+        if (other.min < min) min = other.min;
+        if (other.max > max) max = other.max;
+    }
+};
+
+//Aggregation kernels over one contiguous column. SSE2 is part of the x86-64 baseline, so no runtime
+//dispatch is needed; other targets use the scalar loops.
+namespace TelemetryKernels {
+    template<typename T>
+    inline void reduceScalar(const T *values, const size_t count, TelemetryAggregate &out) {
+        for (size_t i = 0; i < count; ++i) {
+            const double v = static_cast<double>(values[i]);
+            if (v < out.min) out.min = v;
+            if (v > out.max) out.max = v;
+            out.sum += v;
+        }
+        out.count += count;
+    }
+
+#if defined(__SSE2__)
+    namespace detail {
+        inline void finish(const __m128d minPair, const __m128d maxPair, const __m128d sumPair,
+                           const size_t count, TelemetryAggregate &out) {
+            double mins[2], maxs[2], sums[2];
+            _mm_storeu_pd(mins, minPair);
+            _mm_storeu_pd(maxs, maxPair);
+            _mm_storeu_pd(sums, sumPair);
+            TelemetryAggregate block;
+            block.count = count;
+            block.min = std::min(mins[0], mins[1]);
+            block.max = std::max(maxs[0], maxs[1]);
+            block.sum = sums[0] + sums[1];
+            out.merge(block);
+        }
+
+        //Four int32 lanes at a time; SSE2 has no pminsd, so select with compare masks
+        inline void reduceInt32Lanes(const __m128i *lanes, const size_t blocks, TelemetryAggregate &out,
+                                     __m128i (*widen)(const __m128i *, size_t)) {
+            __m128i vmin = widen(lanes, 0);
+            __m128i vmax = vmin;
+            __m128d sumLow = _mm_setzero_pd();
+            __m128d sumHigh = _mm_setzero_pd();
+            for (size_t b = 0; b < blocks; ++b) {
+                const __m128i x = widen(lanes, b);
+                const __m128i lt = _mm_cmplt_epi32(x, vmin);
+                vmin = _mm_or_si128(_mm_and_si128(lt, x), _mm_andnot_si128(lt, vmin));
+                const __m128i gt = _mm_cmpgt_epi32(x, vmax);
+                vmax = _mm_or_si128(_mm_and_si128(gt, x), _mm_andnot_si128(gt, vmax));
+                sumLow = _mm_add_pd(sumLow, _mm_cvtepi32_pd(x));
+                sumHigh = _mm_add_pd(sumHigh, _mm_cvtepi32_pd(_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2))));
+            }
+            const __m128d minPair = _mm_min_pd(_mm_cvtepi32_pd(vmin),
+                                               _mm_cvtepi32_pd(_mm_shuffle_epi32(vmin, _MM_SHUFFLE(1, 0, 3, 2))));
+            const __m128d maxPair = _mm_max_pd(_mm_cvtepi32_pd(vmax),
+                                               _mm_cvtepi32_pd(_mm_shuffle_epi32(vmax, _MM_SHUFFLE(1, 0, 3, 2))));
+            finish(minPair, maxPair, _mm_add_pd(sumLow, sumHigh), blocks * 4, out);
+        }
+
+        inline __m128i loadInt32(const __m128i *base, const size_t block) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i *>(reinterpret_cast<const int32_t *>(base) + block * 4));
+        }
+
+        //Zero-extends four uint16 values to int32 lanes
+        inline __m128i loadUint16(const __m128i *base, const size_t block) {
+            const __m128i x = _mm_loadl_epi64(
+                reinterpret_cast<const __m128i *>(reinterpret_cast<const uint16_t *>(base) + block * 4));
+            return _mm_unpacklo_epi16(x, _mm_setzero_si128());
+        }
+    }
+
+    inline void reduce(const float *values, const size_t count, TelemetryAggregate &out) {
+        const size_t blocks = count / 4;
+        if (blocks > 0) {
+            __m128 vmin = _mm_loadu_ps(values);
+            __m128 vmax = vmin;
+            __m128d sumLow = _mm_setzero_pd();
+            __m128d sumHigh = _mm_setzero_pd();
+            for (size_t b = 0; b < blocks; ++b) {
+                const __m128 x = _mm_loadu_ps(&values[b * 4]);
+                vmin = _mm_min_ps(vmin, x);
+                vmax = _mm_max_ps(vmax, x);
+                sumLow = _mm_add_pd(sumLow, _mm_cvtps_pd(x));
+                sumHigh = _mm_add_pd(sumHigh, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+            }
+            const __m128d minPair = _mm_min_pd(_mm_cvtps_pd(vmin), _mm_cvtps_pd(_mm_movehl_ps(vmin, vmin)));
+            const __m128d maxPair = _mm_max_pd(_mm_cvtps_pd(vmax), _mm_cvtps_pd(_mm_movehl_ps(vmax, vmax)));
+            detail::finish(minPair, maxPair, _mm_add_pd(sumLow, sumHigh), blocks * 4, out);
+        }
+        reduceScalar(&values[blocks * 4], count - blocks * 4, out);
+    }
+
+    inline void reduce(const int32_t *values, const size_t count, TelemetryAggregate &out) {
+        const size_t blocks = count / 4;
+        if (blocks > 0) {
+            detail::reduceInt32Lanes(reinterpret_cast<const __m128i *>(values), blocks, out, detail::loadInt32);
+        }
+        reduceScalar(&values[blocks * 4], count - blocks * 4, out);
+    }
+
+    inline void reduce(const uint16_t *values, const size_t count, TelemetryAggregate &out) {
+        const size_t blocks = count / 4;
+        if (blocks > 0) {
+            detail::reduceInt32Lanes(reinterpret_cast<const __m128i *>(values), blocks, out, detail::loadUint16);
+        }
+        reduceScalar(&values[blocks * 4], count - blocks * 4, out);
+    }
+#else
+    template<typename T>
+    inline void reduce(const T *values, const size_t count, TelemetryAggregate &out) {
+        reduceScalar(values, count, out);
+    }
+#endif
+}
+
+//Per-source columnar store for decoded telemetry. Each source is a series of fixed-size chunks holding
+//a timestamp column and a value column typed by the series' ValueType (INT32, UINT16 or FLOAT).
+//Appends must be in timestamp order per source. A series keeps at most maxChunksPerSource chunks;
+//the oldest chunk is recycled for new samples, so memory stays bounded and steady-state appends do
+//not allocate. Not thread-safe: use one store per ingest worker or synchronize externally.
+template<size_t ChunkSamples = 4096>
+class TelemetryStore {
+public:
+    struct Stats {
+        uint64_t appended = 0;
+        uint64_t rejectedType = 0; //STRING/EMPTY or a type change within a series
+        uint64_t rejectedOrder = 0; //timestamp older than the series' last sample
+        uint64_t evictedSamples = 0;
+    };
+
+    //Zero-copy range visitor: called once per chunk with contiguous columns. values points at
+    //count elements of the series' type (int32_t, uint16_t or float).
+    using RangeVisitor = void (*)(void *context, ValueType type, const uint32_t *timestamps,
+                                  const void *values, size_t count);
+
+private:
+    struct Chunk {
+        uint32_t timestamps[ChunkSamples];
+        union {
+            float f[ChunkSamples];
+            int32_t i[ChunkSamples];
+            uint16_t u[ChunkSamples];
+        } values;
+        size_t count = 0;
+    };
+
+    struct Series {
+        ValueType type = ValueType::EMPTY;
+        std::deque<std::unique_ptr<Chunk> > chunks;
+    };
+
+    size_t maxChunksPerSource;
+    std::unordered_map<uint16_t, Series> series;
+    Stats statistics;
+
+    static const void *column(const Chunk &chunk, const ValueType type, const size_t offset) {
+        switch (type) {
+            case ValueType::FLOAT: return &chunk.values.f[offset];
+            case ValueType::INT32: return &chunk.values.i[offset];
+            default: return &chunk.values.u[offset];
+        }
+    }
+
+    static void reduceColumn(const Chunk &chunk, const ValueType type, const size_t first, const size_t last,
+                             TelemetryAggregate &out) {
+        switch (type) {
+            case ValueType::FLOAT: TelemetryKernels::reduce(&chunk.values.f[first], last - first, out); break;
+            case ValueType::INT32: TelemetryKernels::reduce(&chunk.values.i[first], last - first, out); break;
+            default: TelemetryKernels::reduce(&chunk.values.u[first], last - first, out); break;
+        }
+    }
+
+    //Calls fn(chunk, first, last) for the sample range [from, to] of every overlapping chunk
+    template<typename Fn>
+    void forEachSpan(const uint16_t sourceID, const uint32_t from, const uint32_t to, Fn &&fn) const {
+        const auto it = series.find(sourceID);
+        if (it == series.end() || from > to) return;
+
+        for (const std::unique_ptr<Chunk> &chunk : it->second.chunks) {
+            if (chunk->count == 0 || chunk->timestamps[chunk->count - 1] < from) continue;
+            if (chunk->timestamps[0] > to) break;
+            const uint32_t *begin = chunk->timestamps;
+            const uint32_t *end = chunk->timestamps + chunk->count;
+            const size_t first = std::lower_bound(begin, end, from) - begin;
+            const size_t last = std::upper_bound(begin, end, to) - begin;
+            if (first < last) fn(*chunk, it->second.type, first, last);
+        }
+    }
+
+public:
+    explicit TelemetryStore(const size_t maxChunksPerSource = 64)
+        : maxChunksPerSource(maxChunksPerSource > 0 ? maxChunksPerSource : 1) {
+    }
+
+    bool append(const TelemetryData &telemetry) {
+        const ValueType type = telemetry.getType();
+        if (type != ValueType::FLOAT && type != ValueType::INT32 && type != ValueType::UINT16) {
+            statistics.rejectedType++;
+            return false;
+        }
+
+        Series &s = series[telemetry.sourceID];
+        if (s.type == ValueType::EMPTY) {
+            s.type = type;
+        } else if (s.type != type) {
+            statistics.rejectedType++;
+            return false;
+        }
+
+        if (!s.chunks.empty()) {
+            const Chunk &tailChunk = *s.chunks.back();
+            if (tailChunk.count > 0 && telemetry.timestamp < tailChunk.timestamps[tailChunk.count - 1]) {
+                statistics.rejectedOrder++;
+                return false;
+            }
+        }
+
+        if (s.chunks.empty() || s.chunks.back()->count == ChunkSamples) {
+            std::unique_ptr<Chunk> chunk;
+            if (s.chunks.size() >= maxChunksPerSource) {
+                chunk = std::move(s.chunks.front());
+                s.chunks.pop_front();
+                statistics.evictedSamples += chunk->count;
+                chunk->count = 0;
+            } else {
+                chunk.reset(new Chunk);
+            }
+            s.chunks.push_back(std::move(chunk));
+        }
+
+        Chunk &chunk = *s.chunks.back();
+        chunk.timestamps[chunk.count] = telemetry.timestamp;
+        switch (type) {
+            case ValueType::FLOAT: chunk.values.f[chunk.count] = telemetry.unpack<float>(); break;
+            case ValueType::INT32: chunk.values.i[chunk.count] = telemetry.unpack<int32_t>(); break;
+            default: chunk.values.u[chunk.count] = telemetry.unpack<uint16_t>(); break;
+        }
+        chunk.count++;
+        statistics.appended++;
+        return true;
+    }
+
+    //Inclusive timestamp range [from, to]
+    TelemetryAggregate aggregate(const uint16_t sourceID, const uint32_t from, const uint32_t to) const {
+        TelemetryAggregate result;
+        forEachSpan(sourceID, from, to, [&](const Chunk &chunk, const ValueType type, size_t first, size_t last) {
+            reduceColumn(chunk, type, first, last, result);
+        });
+        return result;
+    }
+
+    //Consecutive windows [from + k*window, from + (k+1)*window) up to and including to.
+    //Returns the number of windows written.
+    size_t aggregateWindows(const uint16_t sourceID, const uint32_t from, const uint32_t to, const uint32_t window,
+                            TelemetryAggregate *out, const size_t maxWindows) const {
+        if (window == 0 || from > to) return 0;
+        const uint64_t span = static_cast<uint64_t>(to) - from + 1;
+        size_t windows = static_cast<size_t>((span + window - 1) / window);
+        if (windows > maxWindows) windows = maxWindows;
+        for (size_t w = 0; w < windows; ++w) {
+            out[w] = TelemetryAggregate();
+        }
+
+        forEachSpan(sourceID, from, to, [&](const Chunk &chunk, const ValueType type, size_t first, size_t last) {
+            //Split the span at window boundaries so each piece is one vectorized reduction
+            while (first < last) {
+                const size_t w = (chunk.timestamps[first] - from) / window;
+                if (w >= windows) return;
+                const uint64_t windowEnd = static_cast<uint64_t>(from) + (w + 1) * static_cast<uint64_t>(window);
+                const uint32_t *begin = &chunk.timestamps[first];
+                const uint32_t *end = &chunk.timestamps[last];
+                const size_t pieceEnd = windowEnd > UINT32_MAX
+                                            ? last
+                                            : first + (std::lower_bound(begin, end, static_cast<uint32_t>(windowEnd)) - begin);
+                reduceColumn(chunk, type, first, pieceEnd, out[w]);
+                first = pieceEnd;
+            }
+        });
+        return windows;
+    }
+
+    void visitRange(const uint16_t sourceID, const uint32_t from, const uint32_t to,
+                    const RangeVisitor visitor, void *context) const {
+        forEachSpan(sourceID, from, to, [&](const Chunk &chunk, const ValueType type, size_t first, size_t last) {
+            visitor(context, type, &chunk.timestamps[first], column(chunk, type, first), last - first);
+        });
+    }
+
+    //Copies up to maxSamples samples in [from, to], values widened to double. Returns samples copied.
+    size_t query(const uint16_t sourceID, const uint32_t from, const uint32_t to,
+                 uint32_t *timestamps, double *values, const size_t maxSamples) const {
+        size_t copied = 0;
+        forEachSpan(sourceID, from, to, [&](const Chunk &chunk, const ValueType type, size_t first, size_t last) {
+            for (size_t i = first; i < last && copied < maxSamples; ++i, ++copied) {
+                timestamps[copied] = chunk.timestamps[i];
+                switch (type) {
+                    case ValueType::FLOAT: values[copied] = chunk.values.f[i]; break;
+                    case ValueType::INT32: values[copied] = chunk.values.i[i]; break;
+                    default: values[copied] = chunk.values.u[i]; break;
+                }
+            }
+        });
+        return copied;
+    }
+
+    ValueType seriesType(const uint16_t sourceID) const {
+        const auto it = series.find(sourceID);
+        return it == series.end() ? ValueType::EMPTY : it->second.type;
+    }
+
+    size_t sampleCount(const uint16_t sourceID) const {
+        const auto it = series.find(sourceID);
+        if (it == series.end()) return 0;
+        size_t total = 0;
+        for (const std::unique_ptr<Chunk> &chunk : it->second.chunks) total += chunk->count;
+        return total;
+    }
+
+    size_t memoryUsage() const {
+        size_t chunks = 0;
+        for (const auto &entry : series) chunks += entry.second.chunks.size();
+        return chunks * sizeof(Chunk);
+    }
+
+    const Stats &stats() const { return statistics; }
+};
+
+#endif //SMARTDRIVE_TELEMETRYSTORE_H
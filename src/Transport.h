@@ -0,0 +1,631 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_TRANSPORT_H
+#define SMARTDRIVE_TRANSPORT_H
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+#include "FrameStreamDecoder.h"
+#include "../constants/ProtocolConstants.h"
+#include "../utils/FrameRing.h"
+#include "../utils/Logger.h"
+
+//Called on the link's event-loop thread with one complete, CRC-checked frame; link is the handle addLink() returned
+using LinkFrameHandler = void (*)(void *context, uint64_t link, const uint8_t *frame, size_t frameSize);
+using LinkEventHandler = void (*)(void *context, uint64_t link);
+
+//Byte-stream links (serial TTYs, pseudo-terminals, UNIX/TCP sockets) driven by a few epoll event
+//loops. Link i belongs to loop i % loops, which does all of its reading and framing. Each loop
+//has one FrameStreamDecoder shared by its links; a link only keeps the tail of a split frame
+//between reads, so per-link state is about a hundred bytes in two flat arrays.
+//send() may be called from any thread. It writes straight to the fd when nothing is queued and
+//otherwise appends to a per-link chunk chain that the loop drains with writev(); once a link has
+//maxQueuedBytes pending, send() refuses and the writable handler fires when it has drained to half.
+//A link handle is generation << 32 | slot, so a handle kept past its link's close never reaches
+//whichever link reuses the slot. Sockets are written with MSG_NOSIGNAL and the loop threads block
+//SIGPIPE; a thread calling send() on a pipe or terminal link must block or ignore SIGPIPE itself.
+class Transport {
+public:
+    static constexpr uint64_t INVALID_LINK = UINT64_MAX;
+    static constexpr size_t CHUNK_SIZE = 1024;
+    static constexpr size_t READ_SIZE = 4096;
+    static constexpr size_t OVERFLOW_SIZE = 60 * 1024;
+    static constexpr size_t MAX_IOV = 64;
+
+    struct Stats {
+        size_t links = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t framesReceived = 0;
+        uint64_t bytesDiscarded = 0;
+        uint64_t readCalls = 0;
+        uint64_t bytesSent = 0;
+        uint64_t writeCalls = 0;
+        uint64_t sendsRefused = 0; //backpressure
+    };
+
+private:
+    static constexpr uint32_t NO_CHUNK = UINT32_MAX;
+    static constexpr uint64_t WAKE_EVENT = UINT64_MAX;
+
+    //Owned by the loop thread
+    struct RxState {
+        int fd = -1;
+        uint32_t generation = 0;
+        uint8_t partialSize = 0;
+        uint8_t partial[ProtocolConstants::MAX_FRAME_SIZE];
+    };
+
+    //Guarded by the owning loop's mutex
+    struct TxState {
+        int fd = -1;
+        uint32_t generation = 0;
+        uint32_t head = NO_CHUNK;
+        uint32_t tail = NO_CHUNK;
+        uint32_t queued = 0;
+        bool socket = false; //written with MSG_NOSIGNAL
+        bool installed = false; //registered with epoll
+        bool watching = false; //EPOLLOUT requested
+        bool blocked = false; //a send was refused since the queue last drained
+    };
+
+    struct Chunk {
+        uint32_t next;
+        uint16_t begin;
+        uint16_t end;
+        uint8_t data[CHUNK_SIZE];
+    };
+
+    struct Op {
+        bool add;
+        uint32_t id;
+        uint32_t generation;
+        int fd;
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Loop {
+        int epollFd = -1;
+        int wakeFd = -1;
+        std::thread thread;
+        FrameStreamDecoder decoder;
+        uint64_t current = INVALID_LINK; //link being decoded
+
+        std::mutex mutex;
+        std::vector<Op> ops;
+        std::atomic<bool> hasOps{false};
+        std::vector<Chunk> chunks;
+        uint32_t freeChunk = NO_CHUNK;
+
+        std::atomic<uint64_t> bytesReceived{0};
+        std::atomic<uint64_t> framesReceived{0};
+        std::atomic<uint64_t> bytesDiscarded{0};
+        std::atomic<uint64_t> readCalls{0};
+        std::atomic<uint64_t> bytesSent{0};
+        std::atomic<uint64_t> writeCalls{0};
+        std::atomic<uint64_t> sendsRefused{0};
+
+        uint8_t input[READ_SIZE];
+        uint8_t overflow[OVERFLOW_SIZE];
+    };
+
+    struct HandlerEntry {
+        LinkFrameHandler handler = nullptr;
+        void *context = nullptr;
+    };
+
+    std::vector<std::unique_ptr<Loop> > loops;
+    std::vector<RxState> rx;
+    std::vector<TxState> tx;
+    std::mutex idMutex;
+    std::vector<uint32_t> freeIds;
+    std::atomic<bool> running{false};
+    size_t maxQueuedBytes;
+
+    HandlerEntry handlers[ProtocolConstants::MAX_FRAME_TYPES];
+    LinkEventHandler writableHandler = nullptr;
+    void *writableContext = nullptr;
+    LinkEventHandler closedHandler = nullptr;
+    void *closedContext = nullptr;
+
+    static void bump(std::atomic<uint64_t> &counter, const uint64_t n) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    static uint64_t handleOf(const uint32_t id, const uint32_t generation) {
+        return static_cast<uint64_t>(generation) << 32 | id;
+    }
+
+    static uint32_t idOf(const uint64_t link) { return static_cast<uint32_t>(link); }
+    static uint32_t generationOf(const uint64_t link) { return static_cast<uint32_t>(link >> 32); }
+
+    //Caller holds the link's loop mutex; false for a closed link or one whose slot has been reused
+    bool current(const uint64_t link) const {
+        const uint32_t id = idOf(link);
+        return id < tx.size() && tx[id].fd >= 0 && tx[id].generation == generationOf(link);
+    }
+
+    static ssize_t writeOut(const TxState &t, iovec *iov, const int count) {
+        if (!t.socket) return ::writev(t.fd, iov, count);
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = static_cast<size_t>(count);
+        return ::sendmsg(t.fd, &message, MSG_NOSIGNAL);
+    }
+
+    Loop &loopOf(const uint32_t id) const { return *loops[id % loops.size()]; }
+
+    static void wake(const Loop &loop) {
+        const uint64_t one = 1;
+        if (::write(loop.wakeFd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            LOG(LogLevel::ERROR, "Transport wake-up failed");
+        }
+    }
+
+    void post(const Op &op) {
+        Loop &loop = loopOf(op.id);
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            loop.ops.push_back(op);
+            loop.hasOps.store(true, std::memory_order_release);
+        }
+        wake(loop);
+    }
+
+    //Caller holds loop.mutex
+    static void watchWritable(Loop &loop, const uint32_t id, TxState &t, const bool enable) {
+        if (!t.installed || t.watching == enable) return;
+        epoll_event event{};
+        event.events = EPOLLIN | (enable ? EPOLLOUT : 0u);
+        event.data.u64 = handleOf(id, t.generation);
+        epoll_ctl(loop.epollFd, EPOLL_CTL_MOD, t.fd, &event);
+        t.watching = enable;
+    }
+
+    //Caller holds loop.mutex
+    static void enqueue(Loop &loop, TxState &t, const uint8_t *data, size_t size) {
+        while (size > 0) {
+            if (t.tail == NO_CHUNK || loop.chunks[t.tail].end == CHUNK_SIZE) {
+                uint32_t index = loop.freeChunk;
+                if (index != NO_CHUNK) {
+                    loop.freeChunk = loop.chunks[index].next;
+                } else {
+                    index = static_cast<uint32_t>(loop.chunks.size());
+                    loop.chunks.emplace_back();
+                }
+                Chunk &chunk = loop.chunks[index];
+                chunk.next = NO_CHUNK;
+                chunk.begin = 0;
+                chunk.end = 0;
+                if (t.tail == NO_CHUNK) t.head = index;
+                else loop.chunks[t.tail].next = index;
+                t.tail = index;
+            }
+            Chunk &chunk = loop.chunks[t.tail];
+            const size_t take = CHUNK_SIZE - chunk.end < size ? CHUNK_SIZE - chunk.end : size;
+            memcpy(&chunk.data[chunk.end], data, take);
+            chunk.end = static_cast<uint16_t>(chunk.end + take);
+            t.queued += static_cast<uint32_t>(take);
+            data += take;
+            size -= take;
+        }
+    }
+
+    //Caller holds loop.mutex
+    static void releaseChunks(Loop &loop, TxState &t) {
+        while (t.head != NO_CHUNK) {
+            const uint32_t next = loop.chunks[t.head].next;
+            loop.chunks[t.head].next = loop.freeChunk;
+            loop.freeChunk = t.head;
+            t.head = next;
+        }
+        t.tail = NO_CHUNK;
+        t.queued = 0;
+    }
+
+    //Writes out as much of the link's queue as the fd accepts; returns true if the writable handler is due
+    bool flush(Loop &loop, const uint32_t id) {
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        TxState &t = tx[id];
+        while (t.head != NO_CHUNK) {
+            iovec iov[MAX_IOV];
+            int count = 0;
+            for (uint32_t c = t.head; c != NO_CHUNK && count < static_cast<int>(MAX_IOV); c = loop.chunks[c].next) {
+                iov[count].iov_base = &loop.chunks[c].data[loop.chunks[c].begin];
+                iov[count].iov_len = loop.chunks[c].end - loop.chunks[c].begin;
+                count++;
+            }
+            const ssize_t written = writeOut(t, iov, count);
+            bump(loop.writeCalls, 1);
+            if (written <= 0) {
+                if (written < 0 && errno == EINTR) continue;
+                break;
+            }
+            bump(loop.bytesSent, static_cast<uint64_t>(written));
+            t.queued -= static_cast<uint32_t>(written);
+            for (size_t left = static_cast<size_t>(written); left > 0;) {
+                Chunk &chunk = loop.chunks[t.head];
+                const size_t available = static_cast<size_t>(chunk.end - chunk.begin);
+                const size_t take = available < left ? available : left;
+                chunk.begin = static_cast<uint16_t>(chunk.begin + take);
+                left -= take;
+                if (chunk.begin == chunk.end) {
+                    const uint32_t next = chunk.next;
+                    chunk.next = loop.freeChunk;
+                    loop.freeChunk = t.head;
+                    t.head = next;
+                }
+            }
+            if (t.head == NO_CHUNK) t.tail = NO_CHUNK;
+        }
+        watchWritable(loop, id, t, t.head != NO_CHUNK);
+        if (t.blocked && t.queued <= maxQueuedBytes / 2) {
+            t.blocked = false;
+            return true;
+        }
+        return false;
+    }
+
+    //Ignored unless generation is the one the slot currently holds
+    void closeLink(Loop &loop, const uint32_t id, const uint32_t generation) {
+        RxState &r = rx[id];
+        if (r.fd < 0 || r.generation != generation) return;
+        epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, r.fd, nullptr);
+        ::close(r.fd);
+        r.fd = -1;
+        r.partialSize = 0;
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            releaseChunks(loop, tx[id]);
+            tx[id] = TxState();
+            tx[id].generation = generation; //the next addLink() on this slot moves past it
+        }
+        {
+            std::lock_guard<std::mutex> lock(idMutex);
+            freeIds.push_back(id);
+        }
+        if (closedHandler) closedHandler(closedContext, handleOf(id, generation));
+    }
+
+    void install(Loop &loop, const Op &op) {
+        RxState &r = rx[op.id];
+        r.fd = op.fd;
+        r.generation = op.generation;
+        r.partialSize = 0;
+
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        TxState &t = tx[op.id];
+        t.installed = true;
+        t.watching = t.head != NO_CHUNK;
+        epoll_event event{};
+        event.events = EPOLLIN | (t.watching ? EPOLLOUT : 0u);
+        event.data.u64 = handleOf(op.id, op.generation);
+        if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, op.fd, &event) != 0) {
+            LOG(LogLevel::ERROR, "Link could not be added to epoll");
+        }
+    }
+
+    void runOps(Loop &loop) {
+        std::vector<Op> ops;
+        {
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            ops.swap(loop.ops);
+            loop.hasOps.store(false, std::memory_order_relaxed);
+        }
+        for (const Op &op : ops) {
+            if (op.add) install(loop, op);
+            else closeLink(loop, op.id, op.generation);
+        }
+    }
+
+    //Reads until the fd would block; returns false once the link has closed
+    bool receive(Loop &loop, const uint32_t id) {
+        RxState &r = rx[id];
+        for (;;) {
+            //The kept tail goes in front of the new bytes so the decoder sees one contiguous stream
+            const size_t tail = r.partialSize;
+            memcpy(loop.input, r.partial, tail);
+            iovec iov[2] = {{&loop.input[tail], READ_SIZE - tail}, {loop.overflow, OVERFLOW_SIZE}};
+            const ssize_t got = ::readv(r.fd, iov, 2);
+            bump(loop.readCalls, 1);
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            if (got <= 0) return false; //EOF, reset, or EIO from a pty whose other side closed
+
+            const auto n = static_cast<size_t>(got);
+            bump(loop.bytesReceived, n);
+            const uint64_t discardedBefore = loop.decoder.stats().bytesDiscarded;
+            loop.current = handleOf(id, r.generation);
+            const size_t first = n < READ_SIZE - tail ? n : READ_SIZE - tail;
+            loop.decoder.feed(loop.input, tail + first);
+            if (n > first) loop.decoder.feed(loop.overflow, n - first);
+            loop.current = INVALID_LINK;
+            r.partialSize = static_cast<uint8_t>(loop.decoder.takePending(r.partial));
+            bump(loop.bytesDiscarded, loop.decoder.stats().bytesDiscarded - discardedBefore);
+            if (n < READ_SIZE - tail + OVERFLOW_SIZE) return true;
+        }
+    }
+
+    struct Dispatch {
+        Transport *transport;
+        Loop *loop;
+    };
+
+    static void route(void *context, const uint8_t *frame, const size_t frameSize) {
+        const auto *d = static_cast<Dispatch *>(context);
+        bump(d->loop->framesReceived, 1);
+        const HandlerEntry &entry = d->transport->handlers[frame[0] >> ProtocolConstants::TYPE_SHIFT];
+        if (entry.handler) entry.handler(entry.context, d->loop->current, frame, frameSize);
+    }
+
+    void run(Loop &loop) {
+        //A peer that hangs up mid-write must not kill the process; sockets also pass MSG_NOSIGNAL
+        sigset_t pipe;
+        sigemptyset(&pipe);
+        sigaddset(&pipe, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipe, nullptr);
+
+        Dispatch dispatchContext{this, &loop};
+        for (uint8_t type = 0; type < ProtocolConstants::MAX_FRAME_TYPES; ++type) {
+            loop.decoder.setHandler(static_cast<ProtocolConstants::FrameType>(type), route, &dispatchContext);
+        }
+
+        epoll_event events[256];
+        while (running.load(std::memory_order_acquire)) {
+            if (loop.hasOps.load(std::memory_order_acquire)) runOps(loop);
+            const int count = epoll_wait(loop.epollFd, events, 256, 100);
+            for (int i = 0; i < count; ++i) {
+                if (events[i].data.u64 == WAKE_EVENT) {
+                    uint64_t value;
+                    while (::read(loop.wakeFd, &value, sizeof(value)) > 0) {
+                    }
+                    runOps(loop);
+                    continue;
+                }
+                const uint64_t link = events[i].data.u64;
+                const uint32_t id = idOf(link);
+                const uint32_t generation = generationOf(link);
+                if (rx[id].fd < 0 || rx[id].generation != generation) continue; //closed since the wait
+
+                bool open = true;
+                if (events[i].events & EPOLLOUT) {
+                    if (flush(loop, id) && writableHandler) writableHandler(writableContext, link);
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) open = receive(loop, id);
+                if (!open) closeLink(loop, id, generation);
+            }
+        }
+        runOps(loop);
+    }
+
+public:
+    explicit Transport(const size_t loopCount = 1, const size_t maxLinks = 10000, const size_t maxQueuedBytes = 64 * 1024)
+        : rx(maxLinks), tx(maxLinks), maxQueuedBytes(maxQueuedBytes) {
+        for (size_t i = 0; i < (loopCount ? loopCount : 1); ++i) {
+            std::unique_ptr<Loop> loop(new Loop);
+            loop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+            loop->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u64 = WAKE_EVENT;
+            if (loop->epollFd < 0 || loop->wakeFd < 0 ||
+                epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeFd, &event) != 0) {
+                LOG(LogLevel::ERROR, "Transport event loop could not be created");
+            }
+            loops.push_back(std::move(loop));
+        }
+        freeIds.reserve(maxLinks);
+        for (size_t id = maxLinks; id-- > 0;) freeIds.push_back(static_cast<uint32_t>(id));
+    }
+
+    Transport(const Transport &) = delete;
+    Transport &operator=(const Transport &) = delete;
+
+    ~Transport() {
+        stop();
+        for (size_t id = 0; id < rx.size(); ++id) {
+            if (rx[id].fd >= 0) ::close(rx[id].fd);
+        }
+        for (const std::unique_ptr<Loop> &loop : loops) {
+            for (const Op &op : loop->ops) {
+                if (op.add) ::close(op.fd);
+            }
+            ::close(loop->epollFd);
+            ::close(loop->wakeFd);
+        }
+    }
+
+    //Handlers must be set before start()
+    void setHandler(const ProtocolConstants::FrameType type, const LinkFrameHandler handler, void *context = nullptr) {
+        handlers[static_cast<uint8_t>(type)] = {handler, context};
+    }
+
+    //Called on the loop thread when a link that refused a send has drained to half its limit
+    void setWritableHandler(const LinkEventHandler handler, void *context = nullptr) {
+        writableHandler = handler;
+        writableContext = context;
+    }
+
+    //Called on the loop thread after a link closed (EOF, error or removeLink)
+    void setClosedHandler(const LinkEventHandler handler, void *context = nullptr) {
+        closedHandler = handler;
+        closedContext = context;
+    }
+
+    void start() {
+        if (running.exchange(true)) return;
+        for (const std::unique_ptr<Loop> &loop : loops) {
+            Loop *l = loop.get();
+            l->thread = std::thread([this, l] { run(*l); });
+        }
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        for (const std::unique_ptr<Loop> &loop : loops) {
+            wake(*loop);
+            loop->thread.join();
+        }
+    }
+
+    //Takes ownership of fd (made non-blocking) and returns its link handle, or INVALID_LINK if full
+    uint64_t addLink(const int fd) {
+        uint32_t id;
+        {
+            std::lock_guard<std::mutex> lock(idMutex);
+            if (freeIds.empty()) {
+                LOG(LogLevel::ERROR, "Transport link table full");
+                return INVALID_LINK;
+            }
+            id = freeIds.back();
+            freeIds.pop_back();
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        struct stat info{};
+        const bool socket = fstat(fd, &info) == 0 && S_ISSOCK(info.st_mode);
+        uint32_t generation;
+        {
+            Loop &loop = loopOf(id);
+            std::lock_guard<std::mutex> lock(loop.mutex);
+            TxState &t = tx[id];
+            t.fd = fd;
+            t.socket = socket;
+            generation = ++t.generation;
+        }
+        post({true, id, generation, fd});
+        return handleOf(id, generation);
+    }
+
+    //Closes the link on its loop thread; the closed handler reports when it is gone. Stale handles are ignored.
+    void removeLink(const uint64_t link) {
+        if (idOf(link) >= rx.size()) return;
+        post({false, idOf(link), generationOf(link), -1});
+    }
+
+    //Queues one or more whole frames for link. Returns false if the link is closed or already has
+    //maxQueuedBytes pending (backpressure: wait for the writable handler).
+    bool send(const uint64_t link, const uint8_t *data, const size_t size) {
+        const uint32_t id = idOf(link);
+        if (id >= tx.size()) return false;
+        Loop &loop = loopOf(id);
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        if (!current(link)) return false;
+        TxState &t = tx[id];
+        if (t.queued + size > maxQueuedBytes) {
+            t.blocked = true;
+            bump(loop.sendsRefused, 1);
+            return false;
+        }
+
+        size_t written = 0;
+        if (t.head == NO_CHUNK) {
+            ssize_t n;
+            do {
+                n = t.socket ? ::send(t.fd, data, size, MSG_NOSIGNAL) : ::write(t.fd, data, size);
+            } while (n < 0 && errno == EINTR);
+            bump(loop.writeCalls, 1);
+            if (n > 0) {
+                written = static_cast<size_t>(n);
+                bump(loop.bytesSent, written);
+            } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                return false; //the loop sees the error on its next read and closes the link
+            }
+        }
+        if (written < size) {
+            enqueue(loop, t, &data[written], size - written);
+            watchWritable(loop, id, t, true);
+        }
+        return true;
+    }
+
+    size_t queuedBytes(const uint64_t link) {
+        const uint32_t id = idOf(link);
+        if (id >= tx.size()) return 0;
+        Loop &loop = loopOf(id);
+        std::lock_guard<std::mutex> lock(loop.mutex);
+        return current(link) ? tx[id].queued : 0;
+    }
+
+    Stats stats() {
+        Stats s;
+        {
+            std::lock_guard<std::mutex> lock(idMutex);
+            s.links = rx.size() - freeIds.size();
+        }
+        for (const std::unique_ptr<Loop> &loop : loops) {
+            s.bytesReceived += loop->bytesReceived.load(std::memory_order_relaxed);
+            s.framesReceived += loop->framesReceived.load(std::memory_order_relaxed);
+            s.bytesDiscarded += loop->bytesDiscarded.load(std::memory_order_relaxed);
+            s.readCalls += loop->readCalls.load(std::memory_order_relaxed);
+            s.bytesSent += loop->bytesSent.load(std::memory_order_relaxed);
+            s.writeCalls += loop->writeCalls.load(std::memory_order_relaxed);
+            s.sendsRefused += loop->sendsRefused.load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    //Opens a serial device in raw mode; returns the fd for addLink(), or -1
+    static int openSerial(const char *path, const speed_t baud) {
+        const int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            LOG(LogLevel::ERROR, "Serial device could not be opened");
+            return -1;
+        }
+        termios tio{};
+        if (tcgetattr(fd, &tio) != 0) {
+            ::close(fd);
+            LOG(LogLevel::ERROR, "Not a serial device");
+            return -1;
+        }
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, baud);
+        cfsetospeed(&tio, baud);
+        tio.c_cflag |= CLOCAL | CREAD;
+        tio.c_cc[VMIN] = 0;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+        return fd;
+    }
+
+    //Creates a raw-mode pseudo-terminal pair: the master stands in for a device's serial port
+    static bool openPtyPair(int &master, int &slave) {
+        master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        char name[128];
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0 || ptsname_r(master, name, sizeof(name)) != 0) {
+            if (master >= 0) ::close(master);
+            LOG(LogLevel::ERROR, "Pseudo-terminal could not be created");
+            return false;
+        }
+        slave = ::open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+        termios tio{};
+        if (slave < 0 || tcgetattr(slave, &tio) != 0) {
+            ::close(master);
+            if (slave >= 0) ::close(slave);
+            LOG(LogLevel::ERROR, "Pseudo-terminal could not be opened");
+            return false;
+        }
+        cfmakeraw(&tio);
+        tcsetattr(slave, TCSANOW, &tio);
+        return true;
+    }
+};
+
+#endif //SMARTDRIVE_TRANSPORT_H
@@ -1,7 +1,34 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
 #include "BinaryProtocol.h"
+#include "CaptureFile.h"
+#include "CommandClient.h"
+#include "CompactCodec.h"
+#include "CompressedTelemetry.h"
+#include "Fragmentation.h"
+#include "FrameCodec.h"
+#include "FrameStreamDecoder.h"
+#include "FrameView.h"
+#include "LatestTelemetryTable.h"
+#include "ModuleRegistry.h"
+#include "OutboundScheduler.h"
+#include "ProtocolMetrics.h"
+#include "ReplayEngine.h"
+#include "SettingsRegistry.h"
+#include "TelemetryPipeline.h"
+#include "TelemetryStore.h"
+#include "Transport.h"
+#include "../utils/AsyncLogger.h"
+#include "../utils/FrameRing.h"
 #include "../utils/Logger.h"
+#include "../utils/ObjectPool.h"
 
 // Simple logger callback for console output
 void consoleLogger(LogLevel level, const char* message) {
@@ -248,6 +275,1752 @@ int main() {
         }
     }
 
+    // Test 8: CRC16 engines agree with the bitwise reference
+    {
+        std::cout << "\n--- Test 8: CRC16 Engine Equivalence ---" << std::endl;
+        std::cout << "Active engine: " << CRC16::engineToString(CRC16::activeEngine()) << std::endl;
+
+        const uint8_t checkInput[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+        bool passed = CRC16::compute(checkInput, sizeof(checkInput)) == 0x29B1;
+
+        uint8_t buffer[600];
+        uint32_t seed = 0x12345678;
+        for (uint8_t &b : buffer) {
+            seed = seed * 1664525u + 1013904223u;
+            b = static_cast<uint8_t>(seed >> 24);
+        }
+
+        const CRC16::Engine engines[] = {CRC16::Engine::TABLE, CRC16::Engine::SLICING_BY_8, CRC16::Engine::CLMUL};
+        for (const CRC16::Engine engine : engines) {
+            if (!CRC16::isSupported(engine)) continue;
+            for (size_t length = 0; length <= sizeof(buffer); ++length) {
+                const uint16_t expected = CRC16::updateBitwise(CRC16::INITIAL_VALUE, buffer, length);
+                if (CRC16::update(engine, CRC16::INITIAL_VALUE, buffer, length) != expected) {
+                    std::cout << "Mismatch: " << CRC16::engineToString(engine) << " at length " << length << std::endl;
+                    passed = false;
+                    break;
+                }
+            }
+        }
+
+        if (passed) {
+            std::cout << "✓ PASSED: All CRC16 engines match" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: CRC16 engine mismatch" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 9: Stream decoding with garbage, split frames and corruption
+    {
+        std::cout << "\n--- Test 9: Frame Stream Decoder Resync ---" << std::endl;
+
+        struct Received {
+            int telemetry = 0;
+            int commands = 0;
+            uint32_t timestampSum = 0;
+        };
+
+        uint8_t stream[512];
+        size_t streamSize = 0;
+        const uint8_t garbage[] = {0xFF, 0x02, 0x40, 0x13, 0x22};
+        memcpy(&stream[streamSize], garbage, sizeof(garbage));
+        streamSize += sizeof(garbage);
+
+        for (uint32_t i = 1; i <= 4; ++i) {
+            TelemetryData telem;
+            telem.sourceID = static_cast<uint16_t>(i);
+            telem.timestamp = i * 1000;
+            telem.pack<float>(static_cast<float>(i));
+            SerializedData serialized = protocol.serializeTelemetry(telem);
+            if (i == 2) serialized.data[10] ^= 0x5A; //corrupted, must be dropped
+            memcpy(&stream[streamSize], serialized.data, serialized.size);
+            streamSize += serialized.size;
+        }
+
+        Command cmd;
+        cmd.commandType = 0x0042;
+        SerializedData serializedCmd = protocol.serializeCommand(cmd);
+        memcpy(&stream[streamSize], serializedCmd.data, serializedCmd.size);
+        streamSize += serializedCmd.size;
+
+        bool passed = true;
+        const size_t chunkSizes[] = {1, 3, 7, 29, streamSize};
+        for (const size_t chunk : chunkSizes) {
+            Received received;
+            FrameStreamDecoder decoder;
+            decoder.setHandler(ProtocolConstants::FrameType::TELEMETRY,
+                               [](void *ctx, const uint8_t *frame, size_t frameSize) {
+                                   auto *r = static_cast<Received *>(ctx);
+                                   TelemetryData t;
+                                   BinaryProtocol p;
+                                   if (p.deserializeTelemetry(frame, frameSize, t)) {
+                                       r->telemetry++;
+                                       r->timestampSum += t.timestamp;
+                                   }
+                               }, &received);
+            decoder.setHandler(ProtocolConstants::FrameType::COMMAND,
+                               [](void *ctx, const uint8_t *, size_t) {
+                                   static_cast<Received *>(ctx)->commands++;
+                               }, &received);
+
+            for (size_t offset = 0; offset < streamSize; offset += chunk) {
+                decoder.feed(&stream[offset], std::min(chunk, streamSize - offset));
+            }
+
+            if (received.telemetry != 3 || received.commands != 1 ||
+                received.timestampSum != 1000 + 3000 + 4000 || decoder.pendingBytes() != 0) {
+                std::cout << "Chunk size " << chunk << ": telemetry=" << received.telemetry
+                          << " commands=" << received.commands << std::endl;
+                passed = false;
+            }
+        }
+
+        if (passed) {
+            std::cout << "✓ PASSED: Stream decoder recovered every valid frame" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Stream decoder lost or invented frames" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 10: Serialization into a caller-provided buffer
+    {
+        std::cout << "\n--- Test 10: Caller-Buffer Serialization ---" << std::endl;
+
+        Command cmd;
+        cmd.commandType = 0x0777;
+        TelemetryData telem;
+        telem.sourceID = 7;
+        telem.timestamp = 123;
+        telem.pack<int32_t>(-5);
+
+        uint8_t batch[128];
+        size_t written = protocol.serializeCommand(cmd, batch, sizeof(batch));
+        written += protocol.serializeTelemetry(telem, &batch[written], sizeof(batch) - written);
+
+        SerializedData expectedCmd = protocol.serializeCommand(cmd);
+        SerializedData expectedTelem = protocol.serializeTelemetry(telem);
+
+        uint8_t tooSmall[16];
+        bool passed = written == expectedCmd.size + expectedTelem.size &&
+                      memcmp(batch, expectedCmd.data, expectedCmd.size) == 0 &&
+                      memcmp(&batch[expectedCmd.size], expectedTelem.data, expectedTelem.size) == 0 &&
+                      protocol.serializeCommand(cmd, tooSmall, sizeof(tooSmall)) == 0;
+
+        if (passed) {
+            std::cout << "✓ PASSED: Frames written in place match the wrapper output" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Caller-buffer serialization mismatch" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 11: Zero-copy FrameView access
+    {
+        std::cout << "\n--- Test 11: FrameView In-Place Access ---" << std::endl;
+
+        TelemetryData telem;
+        telem.sourceID = 0x0BEE;
+        telem.timestamp = 55555;
+        telem.pack<float>(-1.25f);
+        SerializedData serialized = protocol.serializeTelemetry(telem);
+
+        // Offset by one byte so the payload fields are misaligned
+        uint8_t unaligned[ProtocolConstants::MAX_FRAME_SIZE + 1];
+        memcpy(&unaligned[1], serialized.data, serialized.size);
+        FrameView view(&unaligned[1], serialized.size);
+
+        bool passed = view.valid() &&
+                      view.is<TelemetryData>() && !view.is<Command>() &&
+                      view.as<TelemetryData>().sourceID() == 0x0BEE &&
+                      view.as<TelemetryData>().timestamp() == 55555 &&
+                      view.as<TelemetryData>().valueType() == ValueType::FLOAT &&
+                      view.as<TelemetryData>().value<float>() == -1.25f;
+
+        // Module reads stop at moduleCount
+        DiscoveryResponse discovery{};
+        discovery.moduleCount = 1;
+        discovery.modules[0].typeID = 7;
+        discovery.modules[1].typeID = 8;
+        SerializedData discoveryFrame = protocol.serializeDiscovery(discovery);
+        FrameView discoveryView(discoveryFrame.data, discoveryFrame.size);
+        passed = passed && discoveryView.is<DiscoveryResponse>() &&
+                 discoveryView.as<DiscoveryResponse>().module(0).typeID == 7 &&
+                 discoveryView.as<DiscoveryResponse>().module(1).typeID == 0 &&
+                 discoveryView.as<DiscoveryResponse>().module(1000).typeID == 0;
+
+        unaligned[5] ^= 0x01;
+        FrameView corrupted(&unaligned[1], serialized.size);
+        passed = passed && !corrupted.valid() && corrupted.status() == FrameStatus::CRC_MISMATCH;
+
+        if (passed) {
+            std::cout << "✓ PASSED: FrameView reads fields in place" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: FrameView field mismatch" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 12: Compile-time codec matches the IProtocol adapter
+    {
+        std::cout << "\n--- Test 12: FrameCodec Compile-Time Frames ---" << std::endl;
+
+        static_assert(FrameCodec::frameSize<Command> == 30, "Command frame must be 30 bytes");
+        static_assert(FrameCodec::frameSize<TelemetryData> == 28, "Telemetry frame must be 28 bytes");
+
+        SettingsData settings;
+        settings.settingsID = 0x0102;
+        settings.pack<uint16_t>(4242);
+
+        uint8_t direct[FrameCodec::frameSize<SettingsData>];
+        const size_t written = FrameCodec::serialize(settings, direct, sizeof(direct));
+        SerializedData viaInterface = protocol.serializeSettings(settings);
+
+        SettingsData decoded;
+        bool passed = written == viaInterface.size &&
+                      memcmp(direct, viaInterface.data, written) == 0 &&
+                      FrameCodec::deserialize(direct, written, decoded) == FrameStatus::OK &&
+                      decoded.settingsID == 0x0102 && decoded.unpack<uint16_t>() == 4242;
+
+        // A settings frame must not decode as telemetry
+        passed = passed && FrameCodec::check<TelemetryData>(direct, written) == FrameStatus::TYPE_MISMATCH;
+
+        if (passed) {
+            std::cout << "✓ PASSED: FrameCodec output matches BinaryProtocol" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: FrameCodec mismatch" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 13: Batch serialization and validation
+    {
+        std::cout << "\n--- Test 13: Telemetry Batch Round-Trip ---" << std::endl;
+
+        constexpr size_t count = 11;
+        TelemetryData samples[count];
+        for (size_t i = 0; i < count; ++i) {
+            samples[i].sourceID = static_cast<uint16_t>(100 + i);
+            samples[i].timestamp = static_cast<uint32_t>(i * 10);
+            samples[i].pack<int32_t>(static_cast<int32_t>(i) - 5);
+        }
+
+        uint8_t batch[count * FrameCodec::frameSize<TelemetryData>];
+        const size_t written = FrameCodec::serializeBatch(samples, count, batch, sizeof(batch));
+
+        bool passed = written == sizeof(batch);
+        for (size_t i = 0; i < count && passed; ++i) {
+            SerializedData single = protocol.serializeTelemetry(samples[i]);
+            passed = memcmp(&batch[i * single.size], single.data, single.size) == 0;
+        }
+
+        TelemetryData decoded[count];
+        size_t decodedCount = 0;
+        passed = passed &&
+                 FrameCodec::deserializeBatch(batch, written, decoded, count, decodedCount) == FrameStatus::OK &&
+                 decodedCount == count && decoded[count - 1].sourceID == 100 + count - 1 &&
+                 decoded[3].unpack<int32_t>() == -2;
+
+        // Corrupt frame 6: the six before it are still delivered
+        batch[6 * FrameCodec::frameSize<TelemetryData> + 9] ^= 0x10;
+        passed = passed &&
+                 FrameCodec::deserializeBatch(batch, written, decoded, count, decodedCount) == FrameStatus::CRC_MISMATCH &&
+                 decodedCount == 6;
+
+        // A bad header later in the same lane group does not hide the earlier CRC error, and once
+        // frame 6 is repaired the frames before the bad header are delivered
+        batch[7 * FrameCodec::frameSize<TelemetryData>] = 0x00;
+        passed = passed &&
+                 FrameCodec::deserializeBatch(batch, written, decoded, count, decodedCount) == FrameStatus::CRC_MISMATCH &&
+                 decodedCount == 6;
+        batch[6 * FrameCodec::frameSize<TelemetryData> + 9] ^= 0x10;
+        const FrameStatus headerStatus = FrameCodec::deserializeBatch(batch, written, decoded, count, decodedCount);
+        passed = passed && headerStatus != FrameStatus::OK && headerStatus != FrameStatus::CRC_MISMATCH &&
+                 decodedCount == 7 && decoded[6].sourceID == 106;
+
+        if (passed) {
+            std::cout << "✓ PASSED: Batch output matches individual frames" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Batch serialization mismatch" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 14: One shared protocol instance hammered from every core
+    {
+        std::cout << "\n--- Test 14: Concurrent Shared Protocol Stress ---" << std::endl;
+
+        struct alignas(64) WorkerResult {
+            uint64_t frames = 0;
+            uint64_t failures = 0;
+        };
+
+        const unsigned threadCount = std::max(4u, std::thread::hardware_concurrency());
+        constexpr uint32_t iterations = 20000;
+        std::vector<WorkerResult> results(threadCount);
+        const IProtocol &shared = protocol;
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threadCount; ++t) {
+            workers.emplace_back([&shared, &results, t] {
+                WorkerResult local;
+                uint8_t buffer[ProtocolConstants::MAX_FRAME_SIZE];
+                for (uint32_t i = 0; i < iterations; ++i) {
+                    TelemetryData telem;
+                    telem.sourceID = static_cast<uint16_t>(t);
+                    telem.timestamp = i;
+                    telem.pack<int32_t>(static_cast<int32_t>(t * iterations + i));
+
+                    const size_t size = shared.serializeTelemetry(telem, buffer, sizeof(buffer));
+                    const uint16_t referenceCrc = CRC16::updateBitwise(CRC16::INITIAL_VALUE, buffer, size - 2);
+
+                    TelemetryData decoded;
+                    const bool ok = size == 28 &&
+                                    ByteOrder::readUint16LE(&buffer[size - 2]) == referenceCrc &&
+                                    shared.deserializeTelemetry(buffer, size, decoded) &&
+                                    decoded.sourceID == t && decoded.timestamp == i &&
+                                    decoded.unpack<int32_t>() == static_cast<int32_t>(t * iterations + i);
+
+                    Command cmd{};
+                    cmd.commandType = static_cast<uint16_t>(i);
+                    cmd.s = static_cast<int16_t>(t);
+                    SerializedData serialized = shared.serializeCommand(cmd);
+                    Command decodedCmd;
+                    const bool cmdOk = shared.deserializeCommand(serialized.data, serialized.size, decodedCmd) &&
+                                       decodedCmd.commandType == cmd.commandType && decodedCmd.s == cmd.s;
+
+                    local.frames += 2;
+                    local.failures += (ok ? 0 : 1) + (cmdOk ? 0 : 1);
+                }
+                results[t] = local;
+            });
+        }
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+
+        uint64_t frames = 0;
+        uint64_t failures = 0;
+        for (const WorkerResult &r : results) {
+            frames += r.frames;
+            failures += r.failures;
+        }
+
+        if (failures == 0 && frames == 2ull * iterations * threadCount) {
+            std::cout << "✓ PASSED: " << frames << " frames across " << threadCount << " threads" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: " << failures << " bad frames under concurrency" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 15: Lock-free frame rings between threads
+    {
+        std::cout << "\n--- Test 15: SPSC/MPSC Frame Ring Hand-Off ---" << std::endl;
+
+        constexpr uint32_t framesPerProducer = 50000;
+        bool passed = true;
+
+        // SPSC: producer serializes in place, consumer parses in place in batches
+        {
+            static SpscFrameRing<256> ring;
+            std::thread producer([] {
+                for (uint32_t i = 0; i < framesPerProducer; ++i) {
+                    FrameSlot *slot;
+                    while (!(slot = ring.claim())) std::this_thread::yield();
+                    TelemetryData telem;
+                    telem.sourceID = 1;
+                    telem.timestamp = i;
+                    slot->size = static_cast<uint16_t>(FrameCodec::serialize(telem, slot->data, sizeof(slot->data)));
+                    ring.publish();
+                }
+            });
+
+            uint32_t expected = 0;
+            while (expected < framesPerProducer) {
+                const size_t n = ring.consume([&](const FrameSlot &slot) {
+                    FrameView view(slot.data, slot.size);
+                    if (!view.is<TelemetryData>() || view.as<TelemetryData>().timestamp() != expected) passed = false;
+                    expected++;
+                }, 32);
+                if (n == 0) std::this_thread::yield();
+            }
+            producer.join();
+            passed = passed && ring.size() == 0;
+        }
+
+        // MPSC: three producers, per-producer order must be preserved
+        {
+            static MpscFrameRing<256> ring;
+            constexpr uint16_t producers = 3;
+            std::vector<std::thread> threads;
+            for (uint16_t p = 0; p < producers; ++p) {
+                threads.emplace_back([p] {
+                    for (uint32_t i = 0; i < framesPerProducer; ++i) {
+                        FrameSlot *slot;
+                        while (!(slot = ring.claim())) std::this_thread::yield();
+                        TelemetryData telem;
+                        telem.sourceID = p;
+                        telem.timestamp = i;
+                        slot->size = static_cast<uint16_t>(FrameCodec::serialize(telem, slot->data, sizeof(slot->data)));
+                        ring.publish(slot);
+                    }
+                });
+            }
+
+            uint32_t next[producers] = {};
+            uint32_t received = 0;
+            while (received < producers * framesPerProducer) {
+                const size_t n = ring.consume([&](const FrameSlot &slot) {
+                    FrameView view(slot.data, slot.size);
+                    const uint16_t source = view.as<TelemetryData>().sourceID();
+                    if (!view.valid() || source >= producers ||
+                        view.as<TelemetryData>().timestamp() != next[source]++) passed = false;
+                    received++;
+                }, 32);
+                if (n == 0) std::this_thread::yield();
+            }
+            for (std::thread &t : threads) t.join();
+            passed = passed && ring.size() == 0;
+        }
+
+        if (passed) {
+            std::cout << "✓ PASSED: All frames handed off in order" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Frame ring lost or reordered frames" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 16: Sharded telemetry pipeline keeps per-source order under skew
+    {
+        std::cout << "\n--- Test 16: Parallel Telemetry Pipeline ---" << std::endl;
+
+        struct Tracker {
+            uint32_t next[16] = {};
+            std::atomic<bool> ordered{true};
+            std::atomic<uint32_t> total{0};
+        };
+        static Tracker tracker;
+
+        TelemetryPipeline<> pipeline(4, [](void *ctx, const TelemetryData &t) {
+            auto *tr = static_cast<Tracker *>(ctx);
+            if (t.sourceID >= 16 || t.timestamp != tr->next[t.sourceID]++) tr->ordered = false;
+            tr->total.fetch_add(1, std::memory_order_relaxed);
+        }, &tracker);
+        pipeline.start();
+
+        // Two links; source 0 is hot and carries most of the traffic
+        constexpr uint32_t hotFrames = 40000;
+        constexpr uint32_t coldFrames = 2000;
+        constexpr uint64_t expected = hotFrames + 15ull * coldFrames;
+        std::vector<std::thread> links;
+        for (uint16_t link = 0; link < 2; ++link) {
+            links.emplace_back([&pipeline, link] {
+                uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+                uint32_t sent[16] = {};
+                for (uint32_t round = 0; round < hotFrames; ++round) {
+                    for (uint16_t source = link; source < 16; source += 2) {
+                        if (source != 0 && round >= coldFrames) continue;
+                        TelemetryData telem;
+                        telem.sourceID = source;
+                        telem.timestamp = sent[source];
+                        telem.pack<float>(static_cast<float>(round));
+                        FrameCodec::serialize(telem, frame, sizeof(frame));
+                        while (!pipeline.submit(frame, sizeof(frame))) std::this_thread::yield();
+                        sent[source]++;
+                    }
+                }
+            });
+        }
+        for (std::thread &l : links) l.join();
+        pipeline.stop();
+
+        const auto stats = pipeline.stats();
+        std::cout << "Decoded " << stats.decoded << " frames, " << stats.steals << " shard steals, "
+                  << stats.dropped << " back-pressured submits" << std::endl;
+
+        if (tracker.ordered && tracker.total.load() == expected && stats.decoded == expected &&
+            stats.queueDepth == 0) {
+            std::cout << "✓ PASSED: Every source delivered in order" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Pipeline lost or reordered telemetry" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 17: Columnar telemetry store range queries and aggregation
+    {
+        std::cout << "\n--- Test 17: Telemetry Store ---" << std::endl;
+
+        TelemetryStore<256> store(4);
+        bool ok = true;
+
+        // Source 1 is float, source 2 uint16; timestamps 0..1999, so source 1 spans more chunks than it may keep
+        for (uint32_t ts = 0; ts < 2000; ++ts) {
+            TelemetryData f;
+            f.sourceID = 1;
+            f.timestamp = ts;
+            f.pack<float>(static_cast<float>(ts) * 0.5f);
+            ok &= store.append(f);
+
+            TelemetryData u;
+            u.sourceID = 2;
+            u.timestamp = ts;
+            u.pack<uint16_t>(static_cast<uint16_t>(ts % 100));
+            ok &= store.append(u);
+        }
+
+        // Out-of-order and type-changing samples are refused
+        TelemetryData late;
+        late.sourceID = 1;
+        late.timestamp = 10;
+        late.pack<float>(1.0f);
+        TelemetryData retyped;
+        retyped.sourceID = 2;
+        retyped.timestamp = 5000;
+        retyped.pack<int32_t>(7);
+        ok &= !store.append(late) && !store.append(retyped);
+
+        // At most 4 chunks of 256 are kept: three full ones plus the partial tail (timestamps 1024..1999)
+        ok &= store.sampleCount(1) == 976 && store.stats().evictedSamples == 2 * 1024;
+
+        const TelemetryAggregate all = store.aggregate(1, 0, UINT32_MAX);
+        ok &= all.count == 976 && all.min == 512.0 && all.max == 999.5;
+
+        const TelemetryAggregate range = store.aggregate(2, 1100, 1199);
+        ok &= range.count == 100 && range.min == 0.0 && range.max == 99.0 && range.mean() == 49.5;
+
+        TelemetryAggregate windows[8];
+        const size_t written = store.aggregateWindows(2, 1100, 1499, 100, windows, 8);
+        for (size_t w = 0; w < written; ++w) {
+            ok &= windows[w].count == 100 && windows[w].sum == 4950.0;
+        }
+        ok &= written == 4;
+
+        uint32_t timestamps[8];
+        double values[8];
+        ok &= store.query(1, 1500, 1502, timestamps, values, 8) == 3 &&
+              timestamps[0] == 1500 && values[2] == 751.0;
+
+        std::cout << "Stored " << store.sampleCount(1) + store.sampleCount(2) << " samples in "
+                  << store.memoryUsage() / 1024 << " KiB" << std::endl;
+
+        if (ok) {
+            std::cout << "✓ PASSED: Range queries and window aggregates match" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Telemetry store returned wrong results" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 18: Compressed telemetry batches round-trip exactly and beat per-sample frames
+    {
+        std::cout << "\n--- Test 18: Compressed Telemetry Frames ---" << std::endl;
+
+        // Eight sources sampled every 10 ms, mixing all three numeric types plus a few irregular values
+        std::vector<TelemetryData> samples;
+        for (uint32_t tick = 0; tick < 50; ++tick) {
+            for (uint16_t source = 100; source < 108; ++source) {
+                TelemetryData t;
+                t.sourceID = source;
+                t.timestamp = 500000 + tick * 10 + (tick == 17 ? 3 : 0);
+                if (source < 104) t.pack<float>(20.0f + static_cast<float>(source) + 0.25f * static_cast<float>(tick % 4));
+                else if (source < 106) t.pack<int32_t>(static_cast<int32_t>(tick) * -1000);
+                else t.pack<uint16_t>(static_cast<uint16_t>(tick == 30 ? 65535 : 4000 + tick));
+                samples.push_back(t);
+            }
+        }
+
+        std::vector<TelemetryData> decoded(samples.size());
+        size_t wireBytes = 0;
+        size_t frames = 0;
+        size_t offset = 0;
+        bool ok = true;
+        while (offset < samples.size() && ok) {
+            uint8_t frame[ProtocolConstants::MAX_FRAME_SIZE];
+            size_t consumed = 0;
+            const size_t written = CompressedTelemetry::encode(&samples[offset], samples.size() - offset,
+                                                               frame, sizeof(frame), consumed);
+            size_t decodedCount = 0;
+            ok = written > 0 && consumed > 0 &&
+                 CompressedTelemetry::decode(frame, written, &decoded[offset], decoded.size() - offset,
+                                             decodedCount) == FrameStatus::OK && decodedCount == consumed;
+            wireBytes += written;
+            frames++;
+            offset += consumed;
+        }
+        ok = ok && memcmp(samples.data(), decoded.data(), samples.size() * sizeof(TelemetryData)) == 0;
+
+        // A corrupted sample count is caught even though the CRC is recomputed over it
+        uint8_t frame[ProtocolConstants::MAX_FRAME_SIZE];
+        size_t consumed = 0;
+        const size_t written = CompressedTelemetry::encode(samples.data(), samples.size(), frame, sizeof(frame), consumed);
+        frame[2]++;
+        ByteOrder::writeUint16LE(&frame[written - 2], CRC16::compute(frame, written - 2));
+        TelemetryData scratch[CompressedTelemetry::MAX_SAMPLES];
+        size_t decodedCount = 0;
+        ok = ok && CompressedTelemetry::decode(frame, written, scratch, CompressedTelemetry::MAX_SAMPLES,
+                                               decodedCount) == FrameStatus::MALFORMED_PAYLOAD && decodedCount == 0;
+
+        // A valid frame decoded into too small a buffer is the caller's problem, not a link reject
+        const size_t valid = CompressedTelemetry::encode(samples.data(), samples.size(), frame, sizeof(frame), consumed);
+        const uint64_t malformedBefore =
+            ProtocolMetrics::snapshot().rejects[static_cast<size_t>(FrameStatus::MALFORMED_PAYLOAD)];
+        ok = ok && CompressedTelemetry::decode(frame, valid, scratch, consumed - 1, decodedCount) ==
+                   FrameStatus::BUFFER_TOO_SMALL && decodedCount == consumed &&
+             ProtocolMetrics::snapshot().rejects[static_cast<size_t>(FrameStatus::MALFORMED_PAYLOAD)] == malformedBefore;
+
+        // Decoding into a dirty, reused buffer leaves no stale value bytes behind
+        memset(static_cast<void *>(scratch), 0xAB, sizeof(scratch));
+        const size_t clean = CompressedTelemetry::encode(samples.data(), samples.size(), frame, sizeof(frame), consumed);
+        ok = ok && CompressedTelemetry::decode(frame, clean, scratch, CompressedTelemetry::MAX_SAMPLES,
+                                               decodedCount) == FrameStatus::OK &&
+             memcmp(samples.data(), scratch, decodedCount * sizeof(TelemetryData)) == 0;
+
+        // A leading STRING sample goes out as a plain TELEMETRY frame so callers keep advancing
+        TelemetryData named[2] = {samples[0], samples[1]};
+        named[0].packString("motor");
+        const size_t plain = CompressedTelemetry::encode(named, 2, frame, sizeof(frame), consumed);
+        TelemetryData text;
+        ok = ok && plain == FrameCodec::frameSize<TelemetryData> && consumed == 1 &&
+             FrameCodec::deserialize(frame, plain, text) == FrameStatus::OK && text.getType() == ValueType::STRING;
+
+        const size_t plainBytes = samples.size() * FrameCodec::frameSize<TelemetryData>;
+        std::cout << samples.size() << " samples: " << plainBytes << " bytes as TELEMETRY, " << wireBytes
+                  << " bytes in " << frames << " compressed frames (" << std::fixed << std::setprecision(1)
+                  << static_cast<double>(plainBytes) / static_cast<double>(wireBytes) << "x)" << std::endl;
+
+        if (ok && wireBytes * 3 < plainBytes) {
+            std::cout << "✓ PASSED: Lossless and at least 3x smaller" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Compressed telemetry round-trip or ratio" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 19: Compact ValueSource encoding, negotiation and fixed-layout compatibility
+    {
+        std::cout << "\n--- Test 19: Compact Value Encoding ---" << std::endl;
+
+        LinkCodec robot;
+        LinkCodec station;
+        LinkCodec legacy(0);
+        bool ok = robot.txEncoding() == WireEncoding::FIXED;
+
+        // Capability exchange: the robot/station link switches, the link to a legacy peer does not
+        uint8_t announcement[ProtocolConstants::MAX_FRAME_SIZE];
+        size_t announcementSize = station.capabilityFrame(announcement, sizeof(announcement));
+        ok &= robot.handleFrame(announcement, announcementSize);
+        announcementSize = robot.capabilityFrame(announcement, sizeof(announcement));
+        ok &= station.handleFrame(announcement, announcementSize);
+        LinkCodec toLegacy;
+        Command notCapability{};
+        notCapability.commandType = 0xFFFF;
+        const SerializedData commandFrame = protocol.serializeCommand(notCapability);
+        ok &= !toLegacy.handleFrame(commandFrame.data, commandFrame.size);
+        announcementSize = legacy.capabilityFrame(announcement, sizeof(announcement));
+        ok &= toLegacy.handleFrame(announcement, announcementSize);
+        ok &= robot.txEncoding() == WireEncoding::COMPACT && toLegacy.txEncoding() == WireEncoding::FIXED;
+
+        // A legacy decoder drops the announcement instead of handing it on as a Command
+        Command misread{};
+        ok &= !protocol.deserializeCommand(announcement, announcementSize, misread) &&
+              FrameCodec::deserialize(announcement, announcementSize, misread) == FrameStatus::PAYLOAD_SIZE_MISMATCH;
+
+        TelemetryData samples[4];
+        samples[0].pack<float>(3.5f);
+        samples[1].pack<uint16_t>(1200);
+        samples[2].pack<int32_t>(-70000);
+        samples[3].packString("ok");
+        size_t fixedBytes = 0;
+        size_t compactBytes = 0;
+        for (uint16_t i = 0; i < 4; ++i) {
+            samples[i].sourceID = static_cast<uint16_t>(40 + i);
+            samples[i].timestamp = 123456u + i;
+
+            uint8_t compact[ProtocolConstants::MAX_FRAME_SIZE];
+            uint8_t fixed[ProtocolConstants::MAX_FRAME_SIZE];
+            const size_t compactSize = robot.serialize(samples[i], compact, sizeof(compact));
+            const size_t fixedSize = toLegacy.serialize(samples[i], fixed, sizeof(fixed));
+            compactBytes += compactSize;
+            fixedBytes += fixedSize;
+
+            // The station decodes both forms; the fixed form is byte-identical to BinaryProtocol
+            TelemetryData fromCompact, fromFixed;
+            ok &= station.deserialize(compact, compactSize, fromCompact) == FrameStatus::OK &&
+                  station.deserialize(fixed, fixedSize, fromFixed) == FrameStatus::OK &&
+                  memcmp(&fromCompact, &samples[i], sizeof(TelemetryData)) == 0 &&
+                  memcmp(&fromFixed, &samples[i], sizeof(TelemetryData)) == 0 &&
+                  memcmp(fixed, protocol.serializeTelemetry(samples[i]).data, fixedSize) == 0;
+        }
+
+        SettingsData setting;
+        setting.settingsID = 9;
+        setting.pack<uint16_t>(50);
+        uint8_t settingFrame[ProtocolConstants::MAX_FRAME_SIZE];
+        const size_t settingSize = robot.serialize(setting, settingFrame, sizeof(settingFrame));
+        SettingsData settingOut;
+        ok &= settingSize == 9 && station.deserialize(settingFrame, settingSize, settingOut) == FrameStatus::OK &&
+              settingOut.settingsID == 9 && settingOut.unpack<uint16_t>() == 50;
+
+        // A compact frame is never mistaken for the fixed layout by strict fixed-only receivers
+        ok &= !protocol.deserializeSettings(settingFrame, settingSize, settingOut);
+
+        // CRC work is proportional to frame size minus the CRC itself
+        std::cout << "4 telemetry frames: " << fixedBytes << " bytes fixed, " << compactBytes << " bytes compact; CRC over "
+                  << fixedBytes - 8 << " vs " << compactBytes - 8 << " bytes" << std::endl;
+
+        if (ok && compactBytes * 3 < fixedBytes * 2) {
+            std::cout << "✓ PASSED: Compact frames negotiated, decoded and smaller" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Compact value encoding" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 20: Capture file round-trip, time seek and decoder tap
+    {
+        std::cout << "\n--- Test 20: Memory-Mapped Capture File ---" << std::endl;
+
+        const std::string path = "/tmp/smartdrive_capture_" + std::to_string(getpid()) + ".bin";
+        unlink(path.c_str());
+        constexpr uint32_t recordCount = 5000;
+        bool ok = true;
+
+        // Small segments so the capture spans several of them
+        CaptureWriter writer;
+        ok &= writer.open(path.c_str(), 16 * 1024);
+        for (uint32_t i = 0; i < recordCount && ok; ++i) {
+            TelemetryData telem;
+            telem.sourceID = static_cast<uint16_t>(i % 7);
+            telem.timestamp = i;
+            telem.pack<int32_t>(static_cast<int32_t>(i));
+            const SerializedData frame = protocol.serializeTelemetry(telem);
+            ok &= writer.appendAt(1000 + i * 10ull, static_cast<uint16_t>(i % 3), frame.data, frame.size);
+        }
+        writer.close();
+
+        // Reopening appends; here the frames arrive through a stream decoder with the capture tapped in
+        struct Delivered {
+            size_t count = 0;
+        } delivered;
+        ok &= writer.open(path.c_str(), 16 * 1024);
+        CaptureTap tap{&writer, 9, [](void *ctx, const uint8_t *, size_t) { static_cast<Delivered *>(ctx)->count++; },
+                       &delivered};
+        FrameStreamDecoder decoder;
+        decoder.setHandler(ProtocolConstants::FrameType::COMMAND, CaptureTap::handler, &tap);
+        Command cmd{};
+        cmd.commandType = 5;
+        const SerializedData cmdFrame = protocol.serializeCommand(cmd);
+        decoder.feed(cmdFrame.data, cmdFrame.size);
+        decoder.feed(cmdFrame.data, cmdFrame.size);
+        writer.close();
+
+        CaptureReader reader;
+        ok &= reader.open(path.c_str()) && reader.recordCount() == recordCount + 2 && delivered.count == 2;
+
+        // Zero-copy iteration straight into the protocol decoder
+        uint32_t expected = 0;
+        size_t commands = 0;
+        reader.forEach([&](const CaptureRecord &record) {
+            TelemetryData telem;
+            if (record.linkId == 9) {
+                commands++;
+            } else if (!protocol.deserializeTelemetry(record.frame, record.size, telem) ||
+                       telem.timestamp != expected || record.linkId != expected % 3 ||
+                       record.timestampNs != 1000 + expected * 10ull) {
+                ok = false;
+            } else {
+                expected++;
+            }
+        });
+        ok &= expected == recordCount && commands == 2;
+
+        // Seek lands on the first record at or after the requested time
+        CaptureRecord record{};
+        ok &= reader.seek(1000 + 3217 * 10ull - 3) && reader.next(record) && record.timestampNs == 1000 + 3217 * 10ull;
+        ok &= reader.seek(1000) && reader.next(record) && record.timestampNs == 1000;
+
+        std::cout << reader.recordCount() << " records in " << reader.segmentCount() << " segments" << std::endl;
+        reader.close();
+        unlink(path.c_str());
+
+        if (ok) {
+            std::cout << "✓ PASSED: Capture replayed, seeked and tapped" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Capture file round-trip" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 21: Replay a capture across workers with per-link order and pacing
+    {
+        std::cout << "\n--- Test 21: Capture Replay Engine ---" << std::endl;
+
+        const std::string path = "/tmp/smartdrive_replay_" + std::to_string(getpid()) + ".bin";
+        unlink(path.c_str());
+        constexpr uint16_t links = 4;
+        constexpr int16_t perLink = 2000;
+        bool ok = true;
+
+        // Each Command carries its link in commandType and its per-link sequence number in s. Small
+        // segments give the workers several rounds to split.
+        CaptureWriter writer;
+        ok &= writer.open(path.c_str(), 64 * 1024);
+        for (int16_t seq = 0; seq < perLink; ++seq) {
+            for (uint16_t link = 0; link < links; ++link) {
+                Command cmd{};
+                cmd.commandType = link;
+                cmd.s = seq;
+                const SerializedData frame = protocol.serializeCommand(cmd);
+                ok &= writer.appendAt(1000000ull * seq + link, link, frame.data, frame.size);
+            }
+        }
+        uint8_t corrupted[ProtocolConstants::MAX_FRAME_SIZE];
+        const SerializedData telemFrame = protocol.serializeTelemetry(TelemetryData{});
+        memcpy(corrupted, telemFrame.data, telemFrame.size);
+        corrupted[5] ^= 0xFF;
+        ok &= writer.appendAt(1000000ull * perLink, 0, corrupted, telemFrame.size);
+        writer.close();
+
+        struct Sequencer {
+            int16_t next[links] = {};
+            std::atomic<bool> ordered{true};
+        };
+        static Sequencer sequencer;
+        static const BinaryProtocol &decoder = protocol;
+
+        ReplayEngine engine;
+        engine.setHandler(ProtocolConstants::FrameType::COMMAND, [](void *ctx, const uint8_t *frame, size_t size) {
+            auto *seq = static_cast<Sequencer *>(ctx);
+            Command cmd;
+            if (!decoder.deserializeCommand(frame, size, cmd) || cmd.commandType >= links ||
+                cmd.s != seq->next[cmd.commandType]++) {
+                seq->ordered = false;
+            }
+        }, &sequencer);
+
+        CaptureReader segments;
+        ok &= segments.open(path.c_str()) && segments.segmentCount() > 3;
+        segments.close();
+
+        ReplayEngine::Options options;
+        options.workers = 3;
+        ReplayEngine::Report report;
+        ok &= engine.run(path.c_str(), options, report);
+        const ReplayEngine::TypeStats &commands = report.types[static_cast<uint8_t>(ProtocolConstants::FrameType::COMMAND)];
+        ok &= sequencer.ordered && report.invalid == 1 && commands.frames == uint64_t{links} * perLink;
+        std::cout << "Fast: " << std::fixed << std::setprecision(0) << report.framesPerSecond() << " frames/s, "
+                  << report.bytesPerSecond() / 1e6 << " MB/s, COMMAND " << std::setprecision(1)
+                  << commands.meanNs() << " ns mean / " << commands.maxNs << " ns max" << std::endl;
+
+        // Original timing over a 20 ms window of the recording at 2x speed takes at least 10 ms
+        options.pacing = ReplayPacing::ORIGINAL;
+        options.speed = 2.0;
+        options.workers = 1;
+        options.startNs = 100000000ull;
+        options.endNs = 120000000ull;
+        ok &= engine.run(path.c_str(), options, report);
+        ok &= report.frames == 21 * links - (links - 1) && report.seconds >= 0.010;
+        std::cout << "Paced: " << report.frames << " frames in " << std::setprecision(3) << report.seconds << " s"
+                  << std::endl;
+        unlink(path.c_str());
+
+        if (ok) {
+            std::cout << "✓ PASSED: Replay kept link order and pacing" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Replay engine" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 22: Asynchronous, rate-limited logging keeps a corrupted link from stalling decode
+    {
+        std::cout << "\n--- Test 22: Async Rate-Limited Logger ---" << std::endl;
+
+        struct Capture {
+            std::atomic<uint32_t> messages{0};
+            std::atomic<bool> sawCode{false};
+            std::atomic<bool> sawSuppressed{false};
+            std::thread::id thread;
+        };
+        static Capture capture;
+        Logger::setCallback([](LogLevel, const char* message) {
+            capture.messages++;
+            capture.thread = std::this_thread::get_id();
+            if (strstr(message, "CRC mismatch (E006")) capture.sawCode = true;
+            if (strstr(message, "similar suppressed")) capture.sawSuppressed = true;
+        });
+        AsyncLogger::instance().start();
+
+        TelemetryData telem;
+        telem.pack<float>(1.0f);
+        uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+        FrameCodec::serialize(telem, frame, sizeof(frame));
+        frame[4] ^= 0x01;
+
+        // Two decode threads hammer the same rejecting call site
+        constexpr int perThread = 100000;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> decoders;
+        for (int t = 0; t < 2; ++t) {
+            decoders.emplace_back([&frame] {
+                TelemetryData out;
+                for (int i = 0; i < perThread; ++i) FrameCodec::deserialize(frame, sizeof(frame), out);
+            });
+        }
+        for (std::thread& d : decoders) d.join();
+        const double nsPerCall = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                                 (2.0 * perThread);
+
+        // The first message of the next second carries the count of everything held back
+        const auto second = [] {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+        const auto current = second();
+        while (second() == current) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        TelemetryData out;
+        FrameCodec::deserialize(frame, sizeof(frame), out);
+
+        // A site first running out of its allowance in a later second starts a new window
+        LogRateLimiter site;
+        bool freshWindow = true;
+        for (int i = 0; i < LOG_RATE_LIMIT; ++i) freshWindow &= site.allow();
+        const auto seeded = second();
+        while (second() == seeded) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        freshWindow &= site.allow() && site.takeSuppressed() == 0;
+
+        AsyncLogger::instance().flush();
+        const AsyncLogger::Stats stats = AsyncLogger::instance().stats();
+        const bool offThread = capture.thread != std::this_thread::get_id();
+        AsyncLogger::instance().stop();
+        Logger::setCallback(consoleLogger);
+
+        std::cout << 2 * perThread + 1 << " rejects -> " << capture.messages << " log lines, "
+                  << std::setprecision(1) << nsPerCall << " ns per rejected decode, " << stats.dropped << " dropped"
+                  << std::endl;
+
+        if (capture.messages > 0 && capture.messages <= 3 * LOG_RATE_LIMIT && capture.sawCode &&
+            capture.sawSuppressed && offThread && freshWindow) {
+            std::cout << "✓ PASSED: Errors logged off-thread with codes and suppression counts" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Async logger" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 23: Protocol metrics count frames, rejects and resync bytes across threads
+    {
+        std::cout << "\n--- Test 23: Protocol Metrics ---" << std::endl;
+
+        ProtocolMetrics::reset();
+        constexpr int perThread = 1000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 2; ++t) {
+            workers.emplace_back([] {
+                uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+                TelemetryData telem;
+                telem.pack<uint16_t>(1);
+                for (int i = 0; i < perThread; ++i) {
+                    FrameCodec::serialize(telem, frame, sizeof(frame));
+                    FrameCodec::deserialize(frame, sizeof(frame), telem);
+                }
+            });
+        }
+        for (std::thread& w : workers) w.join();
+
+        // Rejects by reason, and line noise in front of a valid frame
+        Command cmd{};
+        SerializedData cmdFrame = protocol.serializeCommand(cmd);
+        TelemetryData wrongType;
+        protocol.deserializeTelemetry(cmdFrame.data, cmdFrame.size, wrongType);
+        cmdFrame.data[5] ^= 0x10;
+        protocol.deserializeCommand(cmdFrame.data, cmdFrame.size, cmd);
+        cmdFrame.data[5] ^= 0x10;
+        FrameStreamDecoder decoder;
+        const uint8_t noise[] = {0xFF, 0x00, 0x11, 0x13};
+        decoder.feed(noise, sizeof(noise));
+        decoder.feed(cmdFrame.data, cmdFrame.size);
+
+        const ProtocolMetrics::Snapshot s = ProtocolMetrics::snapshot();
+        const size_t telemetry = static_cast<size_t>(ProtocolConstants::FrameType::TELEMETRY);
+        const size_t command = static_cast<size_t>(ProtocolConstants::FrameType::COMMAND);
+        bool ok = s.framesEncoded[telemetry] == 2 * perThread && s.framesDecoded[telemetry] == 2 * perThread &&
+                  s.bytesEncoded[telemetry] == 2 * perThread * FrameCodec::frameSize<TelemetryData> &&
+                  s.framesEncoded[command] == 1 &&
+                  s.rejects[static_cast<size_t>(FrameStatus::TYPE_MISMATCH)] == 1 &&
+                  s.rejects[static_cast<size_t>(FrameStatus::CRC_MISMATCH)] == 1 &&
+                  s.resyncBytes == sizeof(noise) &&
+                  s.encodeLatencyNs.total > 0 && s.decodeLatencyNs.total > 0 &&
+                  s.decodeLatencyNs.percentile(50) <= s.decodeLatencyNs.percentile(99);
+
+        // Histogram buckets stay within 1/16 of the recorded value
+        for (uint64_t v : {0ull, 15ull, 16ull, 100ull, 12345ull, 987654321ull}) {
+            const uint64_t low = LatencyHistogram::lowerBound(LatencyHistogram::bucketOf(v));
+            ok &= low <= v && v - low <= v / 16;
+        }
+
+        const std::string path = "/tmp/smartdrive_metrics_" + std::to_string(getpid()) + ".json";
+        ok &= ProtocolMetrics::dumpToFile(path.c_str(), ProtocolMetrics::Format::JSON);
+        std::ifstream dumped(path);
+        const std::string json((std::istreambuf_iterator<char>(dumped)), std::istreambuf_iterator<char>());
+        ok &= json.find("\"crc_mismatch\": 1") != std::string::npos && json.find("\"resync_bytes\": 4") != std::string::npos;
+        unlink(path.c_str());
+
+        std::cout << ProtocolMetrics::format(s, ProtocolMetrics::Format::TEXT);
+
+        if (ok) {
+            std::cout << "✓ PASSED: Metrics aggregated across threads and dumped" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Protocol metrics" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 24: Latest-value table never tears samples and snapshots several sources consistently
+    {
+        std::cout << "\n--- Test 24: Latest Telemetry Table ---" << std::endl;
+
+        static LatestTelemetryTable<64> table;
+        TelemetryData probe;
+        bool ok = !table.read(1, probe);
+
+        TelemetryData sample;
+        sample.sourceID = 1;
+        sample.timestamp = 100;
+        sample.pack<int32_t>(100);
+        ok &= table.update(sample);
+        sample.timestamp = 99;
+        ok &= !table.update(sample) && table.version(1) == 1;
+        sample.sourceID = 64;
+        ok &= !table.update(sample);
+
+        //Writer keeps value == timestamp in every sample and updates source 1 before source 2
+        constexpr uint32_t rounds = 200000;
+        std::atomic<bool> done{false};
+        std::thread writer([&done] {
+            TelemetryData t;
+            for (uint32_t k = 101; k <= 100 + rounds; ++k) {
+                t.pack<int32_t>(static_cast<int32_t>(k));
+                t.timestamp = k;
+                t.sourceID = 1;
+                table.update(t);
+                t.sourceID = 2;
+                table.update(t);
+            }
+            done.store(true);
+        });
+
+        size_t torn = 0, inconsistent = 0, snapshots = 0;
+        const uint16_t ids[2] = {1, 2};
+        TelemetryData pair[2];
+        while (!done.load()) {
+            if (table.read(1, probe) && static_cast<uint32_t>(probe.unpack<int32_t>()) != probe.timestamp) torn++;
+            if (table.snapshot(ids, 2, pair)) {
+                snapshots++;
+                const uint32_t first = pair[0].timestamp, second = pair[1].timestamp;
+                if (first != second && first != second + 1) inconsistent++;
+                if (static_cast<uint32_t>(pair[1].unpack<int32_t>()) != second) torn++;
+            }
+        }
+        writer.join();
+
+        ok &= torn == 0 && inconsistent == 0 && table.read(2, probe) && probe.timestamp == 100 + rounds &&
+              table.version(2) == rounds;
+
+        if (ok) {
+            std::cout << "✓ PASSED: No torn reads, " << snapshots << " consistent snapshots" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: torn=" << torn << " inconsistent=" << inconsistent << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 25: Settings registry applies bursts atomically and diffs versions
+    {
+        std::cout << "\n--- Test 25: Settings Registry ---" << std::endl;
+
+        SettingsRegistry registry;
+        SettingsRegistry::Batch batch;
+        uint8_t frame[64];
+        for (uint16_t id = 0; id < 100; ++id) {
+            SettingsData setting{};
+            setting.settingsID = id;
+            setting.pack<int32_t>(id * 10);
+            const size_t size = (id % 2) ? CompactCodec::serialize(setting, frame, sizeof(frame))
+                                         : FrameCodec::serialize(setting, frame, sizeof(frame));
+            batch.addFrame(frame, size);
+        }
+        bool ok = registry.commit(batch) == 1 && registry.read()->size() == 100;
+
+        SettingsData setting{};
+        {
+            SettingsRegistry::ReadGuard pinned = registry.read();
+            batch.clear();
+            setting.settingsID = 7;
+            setting.pack<int32_t>(70); //unchanged
+            batch.set(setting);
+            setting.settingsID = 42;
+            setting.pack<float>(4.2f);
+            batch.set(setting);
+            ok &= registry.commit(batch) == 2 && registry.commit(batch) == 2;
+
+            SettingsData changes[4];
+            size_t total = 0;
+            SettingsRegistry::ReadGuard latest = registry.read();
+            ok &= latest->diff(1, changes, 4, &total) == 1 && total == 1 && changes[0].settingsID == 42 &&
+                  latest->find(42)->unpack<float>() == 4.2f && latest->diff(0, changes, 4, &total) == 4 && total == 100;
+            ok &= pinned->version() == 1 && pinned->find(42)->unpack<int32_t>() == 420 && registry.pendingReclaim() == 1;
+        }
+        ok &= registry.pendingReclaim() == 0;
+
+        //Settings 1 and 2 always change together, so no reader may see them differ
+        std::atomic<bool> done{false};
+        std::atomic<size_t> mismatches{0};
+        std::thread reader([&] {
+            while (!done.load()) {
+                SettingsRegistry::ReadGuard view = registry.read();
+                if (view->find(1)->unpack<int32_t>() != view->find(2)->unpack<int32_t>()) mismatches++;
+            }
+        });
+        for (int32_t v = 0; v < 2000; ++v) {
+            SettingsRegistry::Batch pair;
+            setting.pack<int32_t>(v);
+            setting.settingsID = 1;
+            pair.set(setting);
+            setting.settingsID = 2;
+            pair.set(setting);
+            registry.commit(pair);
+        }
+        done.store(true);
+        reader.join();
+        ok &= mismatches.load() == 0 && registry.version() == 2002 && registry.pendingReclaim() == 0;
+
+        if (ok) {
+            std::cout << "✓ PASSED: Batched versions, diffs and snapshot reclamation" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Settings registry" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 26: Outbound scheduler sends commands ahead of bulk telemetry and coalesces to the MTU
+    {
+        std::cout << "\n--- Test 26: Outbound Scheduler ---" << std::endl;
+
+        OutboundScheduler scheduler;
+        uint8_t frame[ProtocolConstants::MAX_FRAME_SIZE];
+        TelemetryData telem;
+        telem.pack<float>(1.0f);
+        for (uint16_t i = 0; i < 100; ++i) {
+            telem.sourceID = i;
+            scheduler.enqueue(frame, FrameCodec::serialize(telem, frame, sizeof(frame)), 0);
+        }
+        Command cmd{};
+        cmd.commandType = 5;
+        cmd.x = 1.0f;
+        const size_t commandSize = FrameCodec::serialize(cmd, frame, sizeof(frame));
+        scheduler.enqueue(frame, commandSize, 1000);
+        cmd.x = 2.0f; //supersedes the unsent x = 1
+        scheduler.enqueue(frame, FrameCodec::serialize(cmd, frame, sizeof(frame)), 2000);
+        cmd.commandType = 6;
+        scheduler.enqueue(frame, FrameCodec::serialize(cmd, frame, sizeof(frame)), 3000);
+
+        uint8_t batch[256];
+        const size_t telemetrySize = FrameCodec::frameSize<TelemetryData>;
+        size_t written = scheduler.nextBatch(batch, sizeof(batch), 5000);
+        Command first{}, second{};
+        bool ok = written == 2 * commandSize + (sizeof(batch) - 2 * commandSize) / telemetrySize * telemetrySize &&
+                  FrameCodec::deserialize(batch, commandSize, first) == FrameStatus::OK &&
+                  FrameCodec::deserialize(&batch[commandSize], commandSize, second) == FrameStatus::OK &&
+                  first.commandType == 5 && first.x == 2.0f && second.commandType == 6;
+
+        //Past the 200 ms BULK deadline, queued telemetry overtakes a fresh SETTINGS frame
+        const uint64_t later = 300000000;
+        SettingsData setting{};
+        scheduler.enqueue(frame, FrameCodec::serialize(setting, frame, sizeof(frame)), later);
+        scheduler.nextBatch(batch, sizeof(batch), later);
+        ok &= ProtocolConstants::decodeType(batch[0]) == ProtocolConstants::FrameType::TELEMETRY;
+        while (scheduler.nextBatch(batch, sizeof(batch), later) > 0) {
+        }
+
+        const OutboundScheduler::ClassStats control = scheduler.stats(TrafficClass::CONTROL);
+        const OutboundScheduler::ClassStats bulk = scheduler.stats(TrafficClass::BULK);
+        ok &= control.sent == 2 && control.superseded == 1 && control.latencyNs.max() <= 4000 &&
+              bulk.sent == 100 && bulk.deadlineMisses > 0 && scheduler.pending() == 0 &&
+              scheduler.stats(TrafficClass::NORMAL).sent == 1 && !scheduler.enqueue(frame, 3, 0);
+
+        //A link whose MTU is below the largest frame still sends the frames that fit, one per batch here
+        OutboundScheduler narrow;
+        for (int i = 0; i < 2; ++i) narrow.enqueue(frame, FrameCodec::serialize(telem, frame, sizeof(frame)), 0);
+        const size_t smallMtu = telemetrySize + 1;
+        ok &= smallMtu < ProtocolConstants::MAX_FRAME_SIZE && narrow.nextBatch(batch, smallMtu, 0) == telemetrySize &&
+              narrow.nextBatch(batch, smallMtu, 0) == telemetrySize && narrow.pending() == 0;
+
+        if (ok) {
+            std::cout << "✓ PASSED: Commands first, superseded in place, batches fill the MTU" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Outbound scheduler" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 27: Paged discovery beyond MAX_NUM_MODULES feeds an indexed module registry
+    {
+        std::cout << "\n--- Test 27: Paged Discovery and Module Registry ---" << std::endl;
+
+        constexpr size_t moduleCount = 30;
+        ModuleInfo rig[moduleCount];
+        for (size_t i = 0; i < moduleCount; ++i) {
+            rig[i].typeID = static_cast<uint16_t>(100 + i % 3);
+            rig[i].instanceID = static_cast<uint8_t>(i);
+            rig[i].capabilitiesBitmask = (i % 2 ? 0x1u : 0u) | (i % 5 == 0 ? 0x4u : 0u);
+        }
+
+        uint8_t stream[DiscoveryPaging::MAX_PAGES * ProtocolConstants::MAX_FRAME_SIZE];
+        const size_t streamSize = DiscoveryPaging::encodeAll(rig, moduleCount, 1, stream, sizeof(stream));
+        const size_t pages = DiscoveryPaging::pageCount(moduleCount);
+
+        //Pages arrive through the stream decoder, last one first
+        std::vector<std::vector<uint8_t> > frames;
+        FrameStreamDecoder decoder;
+        decoder.setHandler(ProtocolConstants::FrameType::DISCOVERY,
+                           [](void *context, const uint8_t *frame, const size_t size) {
+                               static_cast<std::vector<std::vector<uint8_t> > *>(context)->emplace_back(frame, frame + size);
+                           }, &frames);
+        decoder.feed(stream, streamSize);
+        ModuleRegistry registry;
+        DiscoveryDiff diff;
+        bool ok = frames.size() == pages && streamSize < pages * FrameCodec::frameSize<DiscoveryResponse>;
+        for (size_t i = frames.size(); i-- > 0;) {
+            ok &= registry.handleFrame(frames[i].data(), frames[i].size(), &diff) == FrameStatus::OK;
+        }
+        ok &= registry.size() == moduleCount && diff.added.size() == moduleCount &&
+              registry.completedDiscoveries() == 1;
+
+        //Odd instances have bit 0, multiples of 5 have bit 2: 5, 15 and 25 have both
+        size_t both = 0;
+        registry.withCapabilities(0x5).forEach([&](const size_t slot) {
+            both++;
+            ok &= registry.at(slot).instanceID % 10 == 5;
+        });
+        ModuleSet type101 = registry.ofType(101);
+        type101 &= registry.withCapabilities(0x1);
+        ok &= both == 3 && registry.ofType(101).count() == 10 && type101.count() == 5 &&
+              registry.withInstance(7).count() == 1;
+
+        //Rediscovery: instance 0 gone, instance 1 gains bit 2, instance 40 new
+        rig[0].instanceID = 40;
+        rig[1].capabilitiesBitmask |= 0x4;
+        const size_t size = DiscoveryPaging::encodeAll(rig, moduleCount, 2, stream, sizeof(stream));
+        frames.clear();
+        decoder.feed(stream, size);
+        for (const std::vector<uint8_t> &page : frames) registry.handleFrame(page.data(), page.size(), &diff);
+        ok &= diff.added.size() == 1 && diff.removed.size() == 1 && diff.changed.size() == 1 &&
+              diff.changed[0].instanceID == 1 && registry.withCapabilities(0x5).count() == 4 &&
+              registry.find(rig[0].typeID, 40) != nullptr && registry.find(100, 0) == nullptr;
+
+        //A late page of generation 2 does not abandon generation 3 in progress
+        rig[5].capabilitiesBitmask = 0x8;
+        std::vector<std::vector<uint8_t> > older = frames;
+        frames.clear();
+        decoder.feed(stream, DiscoveryPaging::encodeAll(rig, moduleCount, 3, stream, sizeof(stream)));
+        registry.handleFrame(frames[0].data(), frames[0].size(), &diff);
+        registry.handleFrame(older[1].data(), older[1].size(), &diff);
+        for (size_t i = 1; i < frames.size(); ++i) registry.handleFrame(frames[i].data(), frames[i].size(), &diff);
+        ok &= registry.completedDiscoveries() == 3 && diff.changed.size() == 1 &&
+              registry.withCapabilities(0x8).count() == 1;
+
+        //Generations compare in serial order, so 0 follows 200
+        rig[5].capabilitiesBitmask = 0x10;
+        for (const uint8_t generation : {100, 200, 0}) {
+            frames.clear();
+            decoder.feed(stream, DiscoveryPaging::encodeAll(rig, moduleCount, generation, stream, sizeof(stream)));
+            for (const std::vector<uint8_t> &page : frames) registry.handleFrame(page.data(), page.size(), &diff);
+        }
+        ok &= registry.completedDiscoveries() == 6 && registry.withCapabilities(0x10).count() == 1;
+
+        //A delayed one-page discovery of an older generation cannot roll the completed one back
+        frames.clear();
+        decoder.feed(stream, DiscoveryPaging::encodeAll(rig, 2, 255, stream, sizeof(stream)));
+        ok &= frames.size() == 1 && registry.handleFrame(frames[0].data(), frames[0].size(), &diff) == FrameStatus::OK &&
+              registry.completedDiscoveries() == 6 && registry.size() == moduleCount;
+
+        //Legacy fixed-size responses still apply as a full set
+        DiscoveryResponse legacy{};
+        legacy.moduleCount = 2;
+        legacy.modules[0] = rig[2];
+        legacy.modules[1] = rig[3];
+        SerializedData legacyFrame = protocol.serializeDiscovery(legacy);
+        ok &= registry.handleFrame(legacyFrame.data, legacyFrame.size, &diff) == FrameStatus::OK &&
+              registry.size() == 2 && diff.removed.size() == moduleCount - 2;
+
+        if (ok) {
+            std::cout << "✓ PASSED: " << pages << " pages, bitset queries and incremental rediscovery" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Paged discovery" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 28: Large messages fragment, interleave with commands and reassemble with integrity checks
+    {
+        std::cout << "\n--- Test 28: Fragmentation and Reassembly ---" << std::endl;
+
+        struct Received {
+            std::vector<uint8_t> data;
+            uint16_t messageID = 0;
+            uint8_t kind = 0;
+            size_t messages = 0;
+        } received;
+
+        std::vector<uint8_t> blob(5000);
+        for (size_t i = 0; i < blob.size(); ++i) blob[i] = static_cast<uint8_t>(i * 31 + 7);
+
+        //Fragments share the link with a command through the scheduler
+        OutboundScheduler scheduler;
+        Fragmentation::Fragmenter fragmenter(77, 3, blob.data(), blob.size());
+        uint8_t frame[ProtocolConstants::MAX_FRAME_SIZE];
+        size_t frameSize;
+        while ((frameSize = fragmenter.next(frame, sizeof(frame))) > 0) scheduler.enqueue(frame, frameSize, 0);
+        Command cmd{};
+        scheduler.enqueue(frame, FrameCodec::serialize(cmd, frame, sizeof(frame)), 0);
+
+        Fragmentation::Reassembler<2, 8192> reassembler;
+        reassembler.setHandler([](void *context, const uint16_t messageID, const uint8_t kind,
+                                  const uint8_t *data, const size_t size) {
+            auto *r = static_cast<Received *>(context);
+            r->data.assign(data, data + size);
+            r->messageID = messageID;
+            r->kind = kind;
+            r->messages++;
+        }, &received);
+
+        FrameStreamDecoder decoder;
+        decoder.setHandler(ProtocolConstants::FrameType::FRAGMENT, decltype(reassembler)::frameHandler, &reassembler);
+        uint8_t batch[512];
+        size_t batchSize = scheduler.nextBatch(batch, sizeof(batch), 0);
+        bool ok = ProtocolConstants::decodeType(batch[0]) == ProtocolConstants::FrameType::COMMAND;
+        for (; batchSize > 0; batchSize = scheduler.nextBatch(batch, sizeof(batch), 0)) decoder.feed(batch, batchSize);
+        ok &= received.messages == 1 && received.data == blob && received.messageID == 77 && received.kind == 3 &&
+              reassembler.activeMessages() == 0;
+
+        //Out of order with duplicates, then a message whose last fragment never arrives
+        std::vector<std::vector<uint8_t> > fragments;
+        Fragmentation::Fragmenter second(78, 1, blob.data(), 1000);
+        while ((frameSize = second.next(frame, sizeof(frame))) > 0) fragments.emplace_back(frame, frame + frameSize);
+        for (size_t i = fragments.size(); i-- > 0;) {
+            reassembler.handleFrame(fragments[i].data(), fragments[i].size(), 1000);
+            if (i % 4 == 0) reassembler.handleFrame(fragments[i].data(), fragments[i].size(), 1000);
+        }
+        ok &= received.messages == 2 && received.messageID == 78 &&
+              std::equal(received.data.begin(), received.data.end(), blob.begin()) && received.data.size() == 1000;
+
+        std::vector<std::vector<uint8_t> > partial;
+        Fragmentation::Fragmenter third(80, 1, blob.data(), 1000);
+        while ((frameSize = third.next(frame, sizeof(frame))) > 0) partial.emplace_back(frame, frame + frameSize);
+        for (size_t i = 0; i + 1 < partial.size(); ++i) {
+            reassembler.handleFrame(partial[i].data(), partial[i].size(), 2000);
+        }
+        ok &= reassembler.activeMessages() == 1;
+
+        //With both slots busy, a late duplicate of the completed message 78 neither opens nor evicts a slot
+        Fragmentation::Fragmenter fourth(81, 1, blob.data(), 1000);
+        frameSize = fourth.next(frame, sizeof(frame));
+        reassembler.handleFrame(frame, frameSize, 2000);
+        const uint64_t lateBefore = reassembler.stats().lateDuplicates;
+        reassembler.handleFrame(fragments[2].data(), fragments[2].size(), 3000);
+        ok &= reassembler.activeMessages() == 2 && reassembler.stats().evicted == 0 &&
+              reassembler.stats().lateDuplicates == lateBefore + 1 && received.messages == 2;
+        reassembler.expire(3000 + 3000000000ull);
+
+        //A message larger than the pool's buffers is refused
+        std::vector<uint8_t> big(9000);
+        Fragmentation::Fragmenter tooLarge(79, 0, big.data(), big.size());
+        frameSize = tooLarge.next(frame, sizeof(frame));
+        reassembler.handleFrame(frame, frameSize, 5000000000ull);
+
+        //An ID reused within the timeout: fragment 0 with a new message CRC starts the new message
+        for (size_t start = 0; start < 2; ++start) {
+            Fragmentation::Fragmenter reused(90, 2, &blob[start], 1000);
+            while ((frameSize = reused.next(frame, sizeof(frame))) > 0) {
+                reassembler.handleFrame(frame, frameSize, 6000000000ull + start);
+            }
+        }
+        ok &= received.messages == 4 && received.messageID == 90 &&
+              std::equal(received.data.begin(), received.data.end(), blob.begin() + 1) && received.data.size() == 1000;
+
+        const auto &stats = reassembler.stats();
+        ok &= stats.completed == 4 && stats.duplicates > 0 && stats.timedOut == 2 && stats.tooLarge == 1 &&
+              stats.corrupt == 0 && reassembler.activeMessages() == 0;
+
+        if (ok) {
+            std::cout << "✓ PASSED: " << fragmenter.totalFragments() << " fragments reassembled around a command" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Fragmentation" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 29: Pool and arena allocation reach a steady state with no further heap growth
+    {
+        std::cout << "\n--- Test 29: Object Pool and Frame Arena ---" << std::endl;
+
+        uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+        TelemetryData telem;
+        telem.pack<int32_t>(5);
+        FrameCodec::serialize(telem, frame, sizeof(frame));
+
+        //Decoded on one thread, released on another
+        const ObjectPool::Stats before = ObjectPool::stats();
+        const size_t telemetryClass = ObjectPool::classOf(sizeof(TelemetryData));
+        uint64_t reservedAfterFirstRound = 0;
+        bool ok = true;
+        for (int round = 0; round < 5; ++round) {
+            std::vector<PoolPtr<TelemetryData> > decoded;
+            for (int i = 0; i < 1000; ++i) {
+                PoolPtr<TelemetryData> t = ObjectPool::make<TelemetryData>();
+                ok &= FrameCodec::deserialize(frame, sizeof(frame), *t) == FrameStatus::OK;
+                decoded.push_back(std::move(t));
+            }
+            ok &= ObjectPool::stats().classes[telemetryClass].live == before.classes[telemetryClass].live + 1000;
+            std::thread consumer([&decoded] { decoded.clear(); });
+            consumer.join();
+            if (round == 0) reservedAfterFirstRound = ObjectPool::stats().classes[telemetryClass].reserved;
+        }
+        const ObjectPool::Stats after = ObjectPool::stats();
+        ok &= after.classes[telemetryClass].live == before.classes[telemetryClass].live &&
+              after.classes[telemetryClass].reserved == reservedAfterFirstRound;
+
+        //One arena per batch: decoded objects, frame copies and a container, all freed by reset()
+        FrameArena arena(4096);
+        size_t blocksAfterFirstBatch = 0;
+        for (int batchIndex = 0; batchIndex < 4; ++batchIndex) {
+            using Allocator = ArenaAllocator<const TelemetryData *>;
+            std::vector<const TelemetryData *, Allocator> batch{Allocator(arena)};
+            for (int i = 0; i < 200; ++i) {
+                const uint8_t *copy = arena.copy(frame, sizeof(frame));
+                TelemetryData *t = arena.make<TelemetryData>();
+                FrameCodec::deserialize(copy, sizeof(frame), *t);
+                batch.push_back(t);
+            }
+            ok &= batch.size() == 200 && batch.back()->unpack<int32_t>() == 5;
+            if (batchIndex == 0) blocksAfterFirstBatch = arena.blockCount();
+            arena.reset();
+        }
+        ok &= arena.bytesUsed() == 0 && arena.highWater() > 200 * sizeof(TelemetryData) &&
+              arena.blockCount() == blocksAfterFirstBatch;
+
+        if (ok) {
+            std::cout << "✓ PASSED: Steady state after first batch (" << reservedAfterFirstRound << " pooled blocks, "
+                      << blocksAfterFirstBatch << " arena blocks)" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Object pool" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 30: Transport serves socketpair and pty links from epoll loops, with backpressure
+    {
+        std::cout << "\n--- Test 30: Epoll Transport ---" << std::endl;
+
+        struct LinkCapture {
+            std::mutex mutex;
+            std::vector<std::pair<uint64_t, uint16_t> > frames; //link, sourceID
+            std::atomic<int> writable{0};
+            std::atomic<int> closed{0};
+        } capture;
+        auto waitFor = [](const auto &predicate) {
+            for (int i = 0; i < 2000 && !predicate(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return predicate();
+        };
+
+        Transport transport(2, 64, 8192);
+        transport.setHandler(ProtocolConstants::FrameType::TELEMETRY,
+                             [](void *context, uint64_t link, const uint8_t *frame, size_t size) {
+                                 auto *c = static_cast<LinkCapture *>(context);
+                                 TelemetryData t;
+                                 if (FrameCodec::deserialize(frame, size, t) != FrameStatus::OK) return;
+                                 std::lock_guard<std::mutex> lock(c->mutex);
+                                 c->frames.emplace_back(link, t.sourceID);
+                             }, &capture);
+        transport.setWritableHandler([](void *context, uint64_t) {
+            static_cast<LinkCapture *>(context)->writable++;
+        }, &capture);
+        transport.setClosedHandler([](void *context, uint64_t) {
+            static_cast<LinkCapture *>(context)->closed++;
+        }, &capture);
+
+        //Four socketpairs plus a pty pair; the peer ends play the robots
+        constexpr int linkCount = 5;
+        uint64_t links[linkCount];
+        int peers[linkCount];
+        bool ok = true;
+        for (int i = 0; i < linkCount - 1; ++i) {
+            int pair[2];
+            ok &= socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+            const int sendBuffer = 4096;
+            setsockopt(pair[0], SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+            links[i] = transport.addLink(pair[0]);
+            peers[i] = pair[1];
+        }
+        int master = -1, slave = -1;
+        ok &= Transport::openPtyPair(master, slave);
+        links[linkCount - 1] = transport.addLink(master);
+        peers[linkCount - 1] = slave;
+        transport.start();
+
+        uint8_t frame[FrameCodec::frameSize<TelemetryData>];
+        TelemetryData telem;
+        telem.pack<int32_t>(1);
+        for (int i = 0; i < linkCount; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                telem.sourceID = static_cast<uint16_t>(i * 10 + k);
+                FrameCodec::serialize(telem, frame, sizeof(frame));
+                if (k == 1) {
+                    //Line noise, then a frame split across two writes
+                    const uint8_t noise[] = {0x00, 0x55, 0x13};
+                    ok &= write(peers[i], noise, sizeof(noise)) == static_cast<ssize_t>(sizeof(noise));
+                    ok &= write(peers[i], frame, 5) == 5;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    ok &= write(peers[i], &frame[5], sizeof(frame) - 5) == static_cast<ssize_t>(sizeof(frame) - 5);
+                } else {
+                    ok &= write(peers[i], frame, sizeof(frame)) == static_cast<ssize_t>(sizeof(frame));
+                }
+            }
+        }
+        ok &= waitFor([&capture] {
+            std::lock_guard<std::mutex> lock(capture.mutex);
+            return capture.frames.size() == linkCount * 3;
+        });
+        {
+            std::lock_guard<std::mutex> lock(capture.mutex);
+            for (const auto &received : capture.frames) {
+                ok &= received.first == links[received.second / 10];
+            }
+        }
+
+        //Outbound: a frame sent to link 0 arrives whole at its peer
+        telem.sourceID = 99;
+        FrameCodec::serialize(telem, frame, sizeof(frame));
+        ok &= transport.send(links[0], frame, sizeof(frame));
+        uint8_t echoed[sizeof(frame)];
+        ok &= read(peers[0], echoed, sizeof(echoed)) == static_cast<ssize_t>(sizeof(echoed)) &&
+              memcmp(echoed, frame, sizeof(frame)) == 0;
+
+        //Backpressure: link 1's peer stops reading until send() refuses, then drains everything
+        size_t accepted = 0;
+        while (accepted < 100000 && transport.send(links[1], frame, sizeof(frame))) accepted++;
+        const bool refused = accepted < 100000 && transport.stats().sendsRefused == 1;
+        fcntl(peers[1], F_SETFL, fcntl(peers[1], F_GETFL) | O_NONBLOCK);
+        size_t drained = 0;
+        ok &= waitFor([&] {
+            uint8_t chunk[4096];
+            ssize_t n;
+            while ((n = read(peers[1], chunk, sizeof(chunk))) > 0) drained += static_cast<size_t>(n);
+            return drained == accepted * sizeof(frame) && capture.writable.load() == 1;
+        });
+        ok &= refused && transport.queuedBytes(links[1]) == 0;
+
+        //A peer hanging up and an explicit removal both close their link
+        close(peers[2]);
+        transport.removeLink(links[3]);
+        ok &= waitFor([&capture] { return capture.closed.load() == 2; });
+        const Transport::Stats stats = transport.stats();
+        ok &= stats.links == linkCount - 2 && stats.framesReceived == linkCount * 3 && stats.bytesDiscarded == 3 * linkCount;
+
+        //The freed slot is reused under a new generation: the old handle neither sends to nor removes it
+        int pair[2];
+        ok &= socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+        const uint64_t reused = transport.addLink(pair[0]);
+        const uint64_t stale = static_cast<uint32_t>(reused) == static_cast<uint32_t>(links[3]) ? links[3] : links[2];
+        ok &= static_cast<uint32_t>(reused) == static_cast<uint32_t>(stale) && reused != stale &&
+              !transport.send(stale, frame, sizeof(frame)) && transport.queuedBytes(stale) == 0;
+        transport.removeLink(stale);
+        ok &= transport.send(reused, frame, sizeof(frame)) &&
+              read(pair[1], echoed, sizeof(echoed)) == static_cast<ssize_t>(sizeof(echoed));
+        transport.stop();
+        ok &= capture.closed.load() == 2;
+        for (int i = 0; i < linkCount; ++i) {
+            if (i != 2) close(peers[i]);
+        }
+        close(pair[1]);
+
+        //Sending to a socket whose peer has gone fails instead of raising SIGPIPE
+        Transport idle;
+        ok &= socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == 0;
+        const uint64_t orphan = idle.addLink(pair[0]);
+        close(pair[1]);
+        ok &= !idle.send(orphan, frame, sizeof(frame));
+
+        if (ok) {
+            std::cout << "✓ PASSED: " << stats.framesReceived << " frames over " << linkCount << " links in "
+                      << stats.readCalls << " reads; backpressure after " << accepted << " frames" << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Transport" << std::endl;
+            testsFailed++;
+        }
+    }
+
+    // Test 31: Pipelined commands complete per window, with retransmission and timeouts
+    {
+        std::cout << "\n--- Test 31: Command Transactions ---" << std::endl;
+
+        struct Wire {
+            std::vector<std::vector<uint8_t> > frames;
+            size_t dropped = 0;
+            bool refuseNext = false;
+        } wire;
+        struct Results {
+            uint16_t values[64] = {};
+            CommandStatus status[64] = {};
+            int calls = 0;
+        } results;
+        auto send = [](void *context, const uint8_t *frame, size_t size) {
+            auto *w = static_cast<Wire *>(context);
+            if (w->refuseNext) {
+                w->refuseNext = false;
+                return false;
+            }
+            w->frames.emplace_back(frame, frame + size);
+            return true;
+        };
+        auto onResult = [](void *context, uint16_t, CommandStatus status, const uint8_t *data, size_t size) {
+            auto *r = static_cast<Results *>(context);
+            const uint16_t value = size == 2 ? ByteOrder::readUint16LE(data) : 0;
+            r->values[value] = value;
+            r->status[value] = status;
+            r->calls++;
+        };
+
+        CommandClient<8>::Options options;
+        options.timeoutNs = 10000000;
+        options.maxRetries = 2;
+        CommandClient<8> client(send, &wire, options);
+
+        //The device echoes commandType as the result, loses the first copy of command 3 and
+        //answers each window out of order
+        auto serve = [&wire, &client](const uint64_t nowNs) {
+            std::vector<std::vector<uint8_t> > requests;
+            requests.swap(wire.frames);
+            for (auto it = requests.rbegin(); it != requests.rend(); ++it) {
+                Transaction::Message message;
+                if (Transaction::decode(it->data(), it->size(), message) != FrameStatus::OK) continue;
+                const uint16_t commandType = message.command.commandType;
+                if (commandType == 3 && wire.dropped++ == 0) continue;
+                uint8_t result[2], response[ProtocolConstants::MAX_FRAME_SIZE];
+                ByteOrder::writeUint16LE(result, commandType);
+                const size_t size = Transaction::encodeResponse(message.sequence, CommandStatus::OK, result,
+                                                                sizeof(result), response, sizeof(response));
+                client.handleFrame(response, size, nowNs);
+            }
+        };
+
+        bool ok = true;
+        for (uint16_t i = 0; i < 20; ++i) {
+            Command command{};
+            command.commandType = i;
+            ok &= client.submit(command, onResult, &results, 0);
+        }
+        ok &= wire.frames.size() == 8 && client.inFlight() == 8 && client.queued() == 12;
+
+        //Each round trip answers a window and releases the next
+        int roundTrips = 0;
+        while (!wire.frames.empty() && roundTrips < 10) {
+            serve(1000000);
+            roundTrips++;
+        }
+        //Command 3's slot stalls the window until its retransmission is answered
+        client.poll(11000000);
+        while (!wire.frames.empty() && roundTrips < 20) {
+            serve(12000000);
+            roundTrips++;
+        }
+        ok &= results.calls == 20 && client.inFlight() == 0 && client.stats().retransmits == 1;
+        for (uint16_t i = 0; i < 20; ++i) ok &= results.values[i] == i && results.status[i] == CommandStatus::OK;
+
+        //An answer to a retransmitted request that was already answered is stale
+        uint8_t late[ProtocolConstants::MAX_FRAME_SIZE];
+        const size_t lateSize = Transaction::encodeResponse(0, CommandStatus::OK, nullptr, 0, late, sizeof(late));
+        client.handleFrame(late, lateSize, 13000000);
+        ok &= client.stats().stale == 1;
+
+        //Unanswered: retransmitted after 10 ms and 20 ms more, timed out 40 ms after that
+        Command silent{};
+        silent.commandType = 40;
+        client.submit(silent, [](void *context, uint16_t, CommandStatus status, const uint8_t *, size_t) {
+            static_cast<Results *>(context)->status[40] = status;
+        }, &results, 20000000);
+        const uint64_t retransmitsBefore = client.stats().retransmits;
+        for (uint64_t now = 20000000; now <= 95000000; now += 1000000) client.poll(now);
+        ok &= results.status[40] == CommandStatus::TIMEOUT && client.stats().timeouts == 1 &&
+              client.stats().retransmits == retransmitsBefore + 2 && client.inFlight() == 0;
+
+#ifdef SMARTDRIVE_HAS_COROUTINES
+        //The same exchange awaited from a coroutine
+        wire.frames.clear();
+        CommandStatus awaited = CommandStatus::TIMEOUT;
+        auto task = [&client, &awaited]() -> CommandTask {
+            Command command{};
+            command.commandType = 7;
+            const auto result = co_await client.request(command, 100000000);
+            awaited = result.size == 2 && ByteOrder::readUint16LE(result.data) == 7 ? result.status : CommandStatus::REJECTED;
+        };
+        task();
+        ok &= awaited == CommandStatus::TIMEOUT && wire.frames.size() == 1;
+        serve(101000000);
+        ok &= awaited == CommandStatus::OK;
+#endif
+
+        //A frame the link refuses is counted as a failure rather than as sent, and the timer retransmits it
+        wire.frames.clear();
+        const uint64_t sentBefore = client.stats().sent;
+        wire.refuseNext = true;
+        Command refused{};
+        refused.commandType = 41;
+        client.submit(refused, onResult, &results, 200000000);
+        ok &= client.stats().sendFailures == 1 && client.stats().sent == sentBefore && wire.frames.empty();
+        client.poll(211000000);
+        ok &= client.stats().sent == sentBefore + 1 && wire.frames.size() == 1;
+        serve(211000000);
+        ok &= results.status[41] == CommandStatus::OK && client.inFlight() == 0;
+
+        if (ok) {
+            std::cout << "✓ PASSED: 20 commands in " << roundTrips << " round trips (window 8), "
+                      << client.stats().retransmits << " retransmits, " << client.stats().timeouts << " timeout"
+                      << std::endl;
+            testsPassed++;
+        } else {
+            std::cout << "✗ FAILED: Command transactions" << std::endl;
+            testsFailed++;
+        }
+    }
+
     // Summary
     std::cout << "\n=== Test Summary ===" << std::endl;
     std::cout << "Passed: " << testsPassed << std::endl;
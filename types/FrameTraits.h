@@ -0,0 +1,48 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_FRAMETRAITS_H
+#define SMARTDRIVE_FRAMETRAITS_H
+
+#include <cstddef>
+#include "../constants/ProtocolConstants.h"
+#include "ProtocolTypes.h"
+#include "RobotData.h"
+#include "ValueSource.h"
+
+//Maps each fixed-layout payload struct to its frame type and wire size
+template<typename T>
+struct FrameTraits;
+
+template<>
+struct FrameTraits<Command> {
+    static constexpr ProtocolConstants::FrameType type = ProtocolConstants::FrameType::COMMAND;
+    static constexpr size_t payloadSize = sizeof(Command);
+};
+
+template<>
+struct FrameTraits<DiscoveryResponse> {
+    static constexpr ProtocolConstants::FrameType type = ProtocolConstants::FrameType::DISCOVERY;
+    static constexpr size_t payloadSize = sizeof(DiscoveryResponse);
+};
+
+template<>
+struct FrameTraits<ValueSource> {
+    static constexpr ProtocolConstants::FrameType type = ProtocolConstants::FrameType::VALUE_SOURCE;
+    static constexpr size_t payloadSize = sizeof(ValueSource);
+};
+
+template<>
+struct FrameTraits<TelemetryData> {
+    static constexpr ProtocolConstants::FrameType type = ProtocolConstants::FrameType::TELEMETRY;
+    static constexpr size_t payloadSize = sizeof(TelemetryData);
+};
+
+template<>
+struct FrameTraits<SettingsData> {
+    static constexpr ProtocolConstants::FrameType type = ProtocolConstants::FrameType::SETTINGS;
+    static constexpr size_t payloadSize = sizeof(SettingsData);
+};
+
+#endif //SMARTDRIVE_FRAMETRAITS_H
@@ -0,0 +1,217 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_ASYNCLOGGER_H
+#define SMARTDRIVE_ASYNCLOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Logger.h"
+
+//What the hot path stores per message; formatting happens later on the logger thread
+struct LogRecord {
+    uint64_t timestampNs;
+    const char *message;
+    uint32_t arg0;
+    uint32_t arg1;
+    uint32_t suppressed;
+    LogCode code;
+    LogLevel level;
+};
+
+//Background backend for Logger. Once started, every LOG/LOG_CODE only copies a LogRecord into
+//a buffer owned by the calling thread (SPSC ring, no locks, no allocation after the thread's first
+//message). A single background thread drains all buffers, formats the records and hands the text
+//to the Logger callback, so slow sinks such as std::endl never stall a decode loop. If a thread's
+//buffer is full the record is dropped and counted.
+class AsyncLogger {
+public:
+    static constexpr size_t BUFFER_RECORDS = 1024;
+
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0;
+        size_t threads = 0;
+    };
+
+private:
+    struct alignas(64) ThreadBuffer {
+        alignas(64) std::atomic<size_t> tail{0}; //producer
+        alignas(64) std::atomic<size_t> head{0}; //logger thread
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};
+        LogRecord records[BUFFER_RECORDS];
+
+        bool push(const LogRecord &record) {
+            const size_t position = tail.load(std::memory_order_relaxed);
+            if (position - head.load(std::memory_order_acquire) == BUFFER_RECORDS) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            records[position % BUFFER_RECORDS] = record;
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+        }
+    };
+
+    //Marks the calling thread's buffer retired when the thread exits; the logger thread frees it once drained
+    struct ThreadHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        ~ThreadHandle() {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> retiredDropped{0};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    AsyncLogger() = default;
+
+    ThreadBuffer &localBuffer() {
+        thread_local ThreadHandle handle;
+        if (!handle.buffer) {
+            handle.buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers.push_back(handle.buffer);
+        }
+        return *handle.buffer;
+    }
+
+    static void sink(const LogLevel level, const LogCode code, const char *message,
+                     const uint32_t arg0, const uint32_t arg1, const uint32_t suppressed) {
+        AsyncLogger &self = instance();
+        const auto now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - self.epoch).count());
+        self.localBuffer().push({now, message, arg0, arg1, suppressed, code, level});
+    }
+
+    static void format(const LogRecord &record, char *text, const size_t capacity) {
+        int length = snprintf(text, capacity, "%s", record.message);
+        if (record.code != LogCode::NONE && length >= 0 && static_cast<size_t>(length) < capacity) {
+            length += snprintf(&text[length], capacity - length, " (E%03u: %u, %u)",
+                               static_cast<unsigned>(record.code), record.arg0, record.arg1);
+        }
+        if (record.suppressed > 0 && length >= 0 && static_cast<size_t>(length) < capacity) {
+            snprintf(&text[length], capacity - length, " [%u similar suppressed]", record.suppressed);
+        }
+    }
+
+    //Drains every buffer once; returns records written
+    size_t drain() {
+        std::vector<std::shared_ptr<ThreadBuffer> > snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            snapshot = buffers;
+        }
+
+        size_t count = 0;
+        char text[256];
+        for (const std::shared_ptr<ThreadBuffer> &buffer : snapshot) {
+            const size_t end = buffer->tail.load(std::memory_order_acquire);
+            size_t position = buffer->head.load(std::memory_order_relaxed);
+            for (; position != end; ++position) {
+                const LogRecord &record = buffer->records[position % BUFFER_RECORDS];
+                format(record, text, sizeof(text));
+                Logger::write(record.level, text);
+                count++;
+            }
+            buffer->head.store(position, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (size_t i = 0; i < buffers.size();) {
+            if (buffers[i]->retired.load(std::memory_order_acquire) && buffers[i]->empty()) {
+                retiredDropped.fetch_add(buffers[i]->dropped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                buffers[i] = buffers.back();
+                buffers.pop_back();
+            } else {
+                ++i;
+            }
+        }
+        written.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    void run() {
+        while (running.load(std::memory_order_acquire)) {
+            if (drain() == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        drain();
+    }
+
+public:
+    static AsyncLogger &instance() {
+        static AsyncLogger logger;
+        return logger;
+    }
+
+    AsyncLogger(const AsyncLogger &) = delete;
+    AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+    ~AsyncLogger() {
+        stop();
+    }
+
+    //Routes Logger through the background thread; the Logger callback is then only called from it
+    void start() {
+        if (running.exchange(true)) return;
+        worker = std::thread(&AsyncLogger::run, this);
+        Logger::setRecordSink(&AsyncLogger::sink);
+    }
+
+    //Restores synchronous logging after writing out everything already queued
+    void stop() {
+        if (!running.load()) return;
+        Logger::setRecordSink(nullptr);
+        running.store(false, std::memory_order_release);
+        worker.join();
+    }
+
+    //Blocks until every record pushed before the call has been handed to the callback
+    void flush() {
+        for (;;) {
+            bool empty = true;
+            {
+                std::lock_guard<std::mutex> lock(registryMutex);
+                for (const std::shared_ptr<ThreadBuffer> &buffer : buffers) {
+                    empty = empty && buffer->empty();
+                }
+            }
+            if (empty || !running.load(std::memory_order_acquire)) return;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    Stats stats() {
+        Stats s;
+        s.written = written.load(std::memory_order_relaxed);
+        s.dropped = retiredDropped.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const std::shared_ptr<ThreadBuffer> &buffer : buffers) {
+            s.dropped += buffer->dropped.load(std::memory_order_relaxed);
+        }
+        s.threads = buffers.size();
+        return s;
+    }
+};
+
+#endif //SMARTDRIVE_ASYNCLOGGER_H
@@ -0,0 +1,36 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_BYTEORDER_H
+#define SMARTDRIVE_BYTEORDER_H
+
+#include <cstdint>
+
+namespace ByteOrder {
+    inline void writeUint16LE(uint8_t *dest, const uint16_t value) {
+        dest[0] = value & 0xFF;
+        dest[1] = (value >> 8) & 0xFF;
+    }
+
+    inline uint16_t readUint16LE(const uint8_t *src) {
+        return static_cast<uint16_t>(src[0]) |
+               (static_cast<uint16_t>(src[1]) << 8);
+    }
+
+    inline void writeUint32LE(uint8_t *dest, const uint32_t value) {
+        dest[0] = value & 0xFF;
+        dest[1] = (value >> 8) & 0xFF;
+        dest[2] = (value >> 16) & 0xFF;
+        dest[3] = (value >> 24) & 0xFF;
+    }
+
+    inline uint32_t readUint32LE(const uint8_t *src) {
+        return static_cast<uint32_t>(src[0]) |
+               (static_cast<uint32_t>(src[1]) << 8) |
+               (static_cast<uint32_t>(src[2]) << 16) |
+               (static_cast<uint32_t>(src[3]) << 24);
+    }
+}
+
+#endif //SMARTDRIVE_BYTEORDER_H
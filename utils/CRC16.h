@@ -0,0 +1,305 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_CRC16_H
+#define SMARTDRIVE_CRC16_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "../Config.h"
+
+#if CRC16_ENABLE_CLMUL && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define CRC16_HAS_CLMUL 1
+    #include <immintrin.h>
+#else
+    #define CRC16_HAS_CLMUL 0
+#endif
+
+//CRC-16/CCITT-FALSE: polynomial 0x1021, init 0xFFFF, MSB first, no final xor.
+//All engines produce bit-identical results; update() routes through the fastest one the CPU supports.
+namespace CRC16 {
+    constexpr uint16_t POLYNOMIAL = 0x1021;
+    constexpr uint16_t INITIAL_VALUE = 0xFFFF;
+
+    enum class Engine : uint8_t {
+        BITWISE = 0,
+        TABLE = 1,
+        SLICING_BY_8 = 2,
+        CLMUL = 3
+    };
+
+    constexpr const char *engineToString(const Engine engine) {
+        switch (engine) {
+            case Engine::BITWISE: return "bitwise";
+            case Engine::TABLE: return "table";
+            case Engine::SLICING_BY_8: return "slicing-by-8";
+            case Engine::CLMUL: return "clmul";
+            default: return "unknown";
+        }
+    }
+
+    namespace detail {
+        struct Tables {
+            //t[k][v] = v * x^(16 + 8k) mod P, i.e. byte v followed by k zero bytes
+            uint16_t t[8][256];
+        };
+
+        constexpr Tables makeTables() {
+            Tables tables{};
+            for (uint16_t v = 0; v < 256; ++v) {
+                uint16_t crc = static_cast<uint16_t>(v << 8);
+                for (uint8_t bit = 0; bit < 8; ++bit) {
+                    crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ POLYNOMIAL)
+                                         : static_cast<uint16_t>(crc << 1);
+                }
+                tables.t[0][v] = crc;
+            }
+            for (size_t k = 1; k < 8; ++k) {
+                for (uint16_t v = 0; v < 256; ++v) {
+                    const uint16_t prev = tables.t[k - 1][v];
+                    tables.t[k][v] = static_cast<uint16_t>((prev << 8) ^ tables.t[0][prev >> 8]);
+                }
+            }
+            return tables;
+        }
+
+        inline constexpr Tables TABLES = makeTables();
+
+        //x^n mod P, used for the carry-less folding constants
+        constexpr uint32_t xPowMod(const unsigned n) {
+            uint32_t r = 1;
+            for (unsigned i = 0; i < n; ++i) {
+                r <<= 1;
+                if (r & 0x10000) r ^= 0x10000u | POLYNOMIAL;
+            }
+            return r;
+        }
+
+        static_assert(TABLES.t[0][1] == POLYNOMIAL, "CRC16 table generation is broken");
+    }
+
+    namespace detail {
+        inline uint16_t tableStep(const uint16_t crc, const uint8_t byte) {
+            return static_cast<uint16_t>((crc << 8) ^ TABLES.t[0][(crc >> 8) ^ byte]);
+        }
+
+        inline uint16_t slice8(const uint16_t crc, const uint8_t *data) {
+            const auto &t = TABLES.t;
+            const uint16_t x = crc ^ static_cast<uint16_t>((data[0] << 8) | data[1]);
+            return t[7][x >> 8] ^ t[6][x & 0xFF] ^
+                   t[5][data[2]] ^ t[4][data[3]] ^
+                   t[3][data[4]] ^ t[2][data[5]] ^
+                   t[1][data[6]] ^ t[0][data[7]];
+        }
+
+        template<size_t... Block>
+        inline uint16_t sliceBlocks(uint16_t crc, const uint8_t *data, std::index_sequence<Block...>) {
+            ((crc = slice8(crc, &data[Block * 8])), ...);
+            return crc;
+        }
+
+        template<size_t... Index>
+        inline uint16_t tableBytes(uint16_t crc, const uint8_t *data, std::index_sequence<Index...>) {
+            ((crc = tableStep(crc, data[Index])), ...);
+            return crc;
+        }
+    }
+
+    inline uint16_t updateBitwise(uint16_t crc, const uint8_t *data, const size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            crc ^= static_cast<uint16_t>(data[i]) << 8;
+
+            for (uint8_t bit = 0; bit < 8; ++bit) {
+                if (crc & 0x8000) {
+                    crc = (crc << 1) ^ POLYNOMIAL;
+                } else {
+                    crc <<= 1;
+                }
+            }
+        }
+        return crc;
+    }
+
+    inline uint16_t updateTable(uint16_t crc, const uint8_t *data, const size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            crc = detail::tableStep(crc, data[i]);
+        }
+        return crc;
+    }
+
+    inline uint16_t updateSlicing8(uint16_t crc, const uint8_t *data, size_t length) {
+        while (length >= 8) {
+            crc = detail::slice8(crc, data);
+            data += 8;
+            length -= 8;
+        }
+        return updateTable(crc, data, length);
+    }
+
+    //Length known at compile time: fully unrolled slicing-by-8, no dispatch, inlinable into the caller
+    template<size_t Length>
+    inline uint16_t computeFixed(const uint8_t *data) {
+        const uint16_t crc = detail::sliceBlocks(INITIAL_VALUE, data, std::make_index_sequence<Length / 8>{});
+        return detail::tableBytes(crc, &data[Length - Length % 8], std::make_index_sequence<Length % 8>{});
+    }
+
+    //Multi-buffer kernel: Lanes independent buffers of the same compile-time length, processed in
+    //lock-step so the table lookups of different buffers overlap instead of waiting on one CRC chain
+    template<size_t Length, size_t Lanes>
+    inline void computeFixedMulti(const uint8_t *const *data, uint16_t *crcOut) {
+        uint16_t crc[Lanes];
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            crc[lane] = INITIAL_VALUE;
+        }
+        for (size_t offset = 0; offset + 8 <= Length; offset += 8) {
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                crc[lane] = detail::slice8(crc[lane], &data[lane][offset]);
+            }
+        }
+        for (size_t offset = Length - Length % 8; offset < Length; ++offset) {
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                crc[lane] = detail::tableStep(crc[lane], data[lane][offset]);
+            }
+        }
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            crcOut[lane] = crc[lane];
+        }
+    }
+
+#if CRC16_HAS_CLMUL
+    //Below this the folding setup costs more than it saves
+    constexpr size_t CLMUL_MIN_LENGTH = 32;
+
+    //Folds 16-byte blocks into a 128-bit accumulator that stays congruent to the message mod P,
+    //then finishes the last accumulator and the tail with the table engine.
+    __attribute__((target("pclmul,ssse3")))
+    inline uint16_t updateClmul(uint16_t crc, const uint8_t *data, size_t length) {
+        if (length < CLMUL_MIN_LENGTH) {
+            return updateSlicing8(crc, data, length);
+        }
+
+        const __m128i byteReverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m128i foldConstants = _mm_set_epi64x(detail::xPowMod(192), detail::xPowMod(128));
+
+        __m128i acc = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)), byteReverse);
+        acc = _mm_xor_si128(acc, _mm_set_epi64x(static_cast<long long>(static_cast<uint64_t>(crc) << 48), 0));
+        data += 16;
+        length -= 16;
+
+        while (length >= 16) {
+            const __m128i next = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data)),
+                                                  byteReverse);
+            const __m128i high = _mm_clmulepi64_si128(acc, foldConstants, 0x11);
+            const __m128i low = _mm_clmulepi64_si128(acc, foldConstants, 0x00);
+            acc = _mm_xor_si128(_mm_xor_si128(high, low), next);
+            data += 16;
+            length -= 16;
+        }
+
+        alignas(16) uint8_t folded[16];
+        _mm_store_si128(reinterpret_cast<__m128i *>(folded), _mm_shuffle_epi8(acc, byteReverse));
+        crc = updateSlicing8(0, folded, sizeof(folded));
+        return updateSlicing8(crc, data, length);
+    }
+#endif
+
+    inline bool isSupported(const Engine engine) {
+        switch (engine) {
+            case Engine::BITWISE:
+            case Engine::TABLE:
+            case Engine::SLICING_BY_8:
+                return true;
+            case Engine::CLMUL:
+#if CRC16_HAS_CLMUL
+                return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+                return false;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    namespace detail {
+        using UpdateFn = uint16_t (*)(uint16_t crc, const uint8_t *data, size_t length);
+
+        inline UpdateFn engineFunction(const Engine engine) {
+            switch (engine) {
+                case Engine::BITWISE: return updateBitwise;
+                case Engine::TABLE: return updateTable;
+#if CRC16_HAS_CLMUL
+                case Engine::CLMUL: return updateClmul;
+#endif
+                default: return updateSlicing8;
+            }
+        }
+
+        //Cross-checks a candidate engine against the bitwise reference before trusting it
+        inline bool selfTest(const Engine engine) {
+            uint8_t sample[257];
+            for (size_t i = 0; i < sizeof(sample); ++i) {
+                sample[i] = static_cast<uint8_t>(i * 167 + 13);
+            }
+            const UpdateFn fn = engineFunction(engine);
+            for (size_t length = 0; length <= sizeof(sample); length += 31) {
+                if (fn(INITIAL_VALUE, sample, length) != updateBitwise(INITIAL_VALUE, sample, length)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        inline Engine detectEngine() {
+            if (isSupported(Engine::CLMUL) && selfTest(Engine::CLMUL)) {
+                return Engine::CLMUL;
+            }
+            return Engine::SLICING_BY_8;
+        }
+
+        struct Dispatch {
+            std::atomic<UpdateFn> fn;
+            std::atomic<Engine> engine;
+
+            Dispatch() {
+                const Engine detected = detectEngine();
+                engine.store(detected, std::memory_order_relaxed);
+                fn.store(engineFunction(detected), std::memory_order_relaxed);
+            }
+        };
+
+        inline Dispatch &dispatch() {
+            static Dispatch instance;
+            return instance;
+        }
+    }
+
+    inline Engine activeEngine() {
+        return detail::dispatch().engine.load(std::memory_order_relaxed);
+    }
+
+    //Overrides the runtime choice (benchmarks, tests). Returns false if the CPU lacks the engine.
+    inline bool selectEngine(const Engine engine) {
+        if (!isSupported(engine)) return false;
+        detail::Dispatch &d = detail::dispatch();
+        d.engine.store(engine, std::memory_order_relaxed);
+        d.fn.store(detail::engineFunction(engine), std::memory_order_relaxed);
+        return true;
+    }
+
+    inline uint16_t update(const Engine engine, const uint16_t crc, const uint8_t *data, const size_t length) {
+        return detail::engineFunction(engine)(crc, data, length);
+    }
+
+    inline uint16_t update(const uint16_t crc, const uint8_t *data, const size_t length) {
+        return detail::dispatch().fn.load(std::memory_order_relaxed)(crc, data, length);
+    }
+
+    inline uint16_t compute(const uint8_t *data, const size_t length) {
+        return update(INITIAL_VALUE, data, length);
+    }
+}
+
+#endif //SMARTDRIVE_CRC16_H
@@ -0,0 +1,223 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_FRAMERING_H
+#define SMARTDRIVE_FRAMERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../constants/ProtocolConstants.h"
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+//One frame-sized slot. Producers serialize straight into data and set size; consumers parse in place.
+struct FrameSlot {
+    uint8_t data[ProtocolConstants::MAX_FRAME_SIZE];
+    uint16_t size = 0;
+};
+
+//Single-producer/single-consumer ring of frame slots. Each side keeps a cached copy of the other
+//side's index, so the shared atomics are only touched when the cache says the ring looks full/empty.
+template<size_t Capacity>
+class SpscFrameRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot : FrameSlot {
+    };
+
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail{0}; //written by the producer
+    size_t cachedHead = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head{0}; //written by the consumer
+    size_t cachedTail = 0;
+
+    Slot slots[Capacity];
+
+public:
+    //Producer: returns the next free slot or nullptr if the ring is full. Nothing is visible until publish().
+    FrameSlot *claim() {
+        const size_t position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == Capacity) {
+                return nullptr;
+            }
+        }
+        return &slots[position & MASK];
+    }
+
+    //Producer: makes the slot returned by the last claim() visible to the consumer
+    void publish() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPush(const uint8_t *frame, const size_t size) {
+        if (size > ProtocolConstants::MAX_FRAME_SIZE) return false;
+        FrameSlot *slot = claim();
+        if (!slot) return false;
+        memcpy(slot->data, frame, size);
+        slot->size = static_cast<uint16_t>(size);
+        publish();
+        return true;
+    }
+
+    //Consumer: oldest published slot or nullptr if empty; stays valid until release()
+    const FrameSlot *peek() {
+        const size_t position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[position & MASK];
+    }
+
+    void release() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    //Consumer: hands up to maxFrames slots to fn(const FrameSlot&) with one acquire and one release in total
+    template<typename Fn>
+    size_t consume(Fn &&fn, const size_t maxFrames) {
+        const size_t position = head.load(std::memory_order_relaxed);
+        cachedTail = tail.load(std::memory_order_acquire);
+        size_t available = cachedTail - position;
+        if (available > maxFrames) available = maxFrames;
+
+        for (size_t i = 0; i < available; ++i) {
+            fn(static_cast<const FrameSlot &>(slots[(position + i) & MASK]));
+        }
+        if (available > 0) {
+            head.store(position + available, std::memory_order_release);
+        }
+        return available;
+    }
+
+    //Approximate when called concurrently with either side
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+};
+
+//Multi-producer/single-consumer bounded ring (per-slot sequence numbers, Vyukov style).
+//Producers contend only on one fetch-position CAS. The consumer's only shared write besides recycling
+//slot sequences is dequeuePosition, stored once per consume() batch (or per release()); producers
+//never read it, other threads only through size().
+template<size_t Capacity>
+class MpscFrameRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot : FrameSlot {
+        std::atomic<size_t> sequence{0};
+        size_t position = 0;
+    };
+
+    static constexpr size_t MASK = Capacity - 1;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePosition{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePosition{0}; //only the consumer writes it
+
+    Slot slots[Capacity];
+
+    bool ready(const Slot &slot, const size_t position) const {
+        return slot.sequence.load(std::memory_order_acquire) == position + 1;
+    }
+
+    void recycle(Slot &slot, const size_t position) {
+        slot.sequence.store(position + Capacity, std::memory_order_release);
+    }
+
+public:
+    MpscFrameRing() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    //Producer: reserves a slot or returns nullptr if the ring is full. Must be followed by publish(slot).
+    FrameSlot *claim() {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &slot = slots[position & MASK];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.position = position;
+                    return &slot;
+                }
+            } else if (difference < 0) {
+                return nullptr;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(FrameSlot *frame) {
+        Slot *slot = static_cast<Slot *>(frame);
+        slot->sequence.store(slot->position + 1, std::memory_order_release);
+    }
+
+    bool tryPush(const uint8_t *frame, const size_t size) {
+        if (size > ProtocolConstants::MAX_FRAME_SIZE) return false;
+        FrameSlot *slot = claim();
+        if (!slot) return false;
+        memcpy(slot->data, frame, size);
+        slot->size = static_cast<uint16_t>(size);
+        publish(slot);
+        return true;
+    }
+
+    const FrameSlot *peek() {
+        const size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        const Slot &slot = slots[position & MASK];
+        return ready(slot, position) ? &slot : nullptr;
+    }
+
+    void release() {
+        const size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        recycle(slots[position & MASK], position);
+        dequeuePosition.store(position + 1, std::memory_order_relaxed);
+    }
+
+    //Consumer: hands up to maxFrames published slots to fn(const FrameSlot&), publishing the new
+    //dequeue position once for the whole batch
+    template<typename Fn>
+    size_t consume(Fn &&fn, const size_t maxFrames) {
+        const size_t start = dequeuePosition.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (count < maxFrames) {
+            Slot &slot = slots[(start + count) & MASK];
+            if (!ready(slot, start + count)) break;
+            fn(static_cast<const FrameSlot &>(slot));
+            recycle(slot, start + count);
+            count++;
+        }
+        if (count > 0) {
+            dequeuePosition.store(start + count, std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    //Claimed-but-unconsumed slots; approximate when called concurrently
+    size_t size() const {
+        const size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+        const size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+};
+
+#endif //SMARTDRIVE_FRAMERING_H
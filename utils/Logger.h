@@ -5,6 +5,9 @@
 #ifndef SMARTDRIVE_LOGGER_H
 #define SMARTDRIVE_LOGGER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include "../Config.h"
 
 enum class LogLevel {
@@ -14,36 +17,139 @@ enum class LogLevel {
     ERROR
 };
 
+//Stable numeric codes for machine-readable logs. Codes 1-7 match FrameStatus values.
+enum class LogCode : uint16_t {
+    NONE = 0,
+    FRAME_TOO_SMALL = 1,
+    INVALID_HEADER = 2,
+    TYPE_MISMATCH = 3,
+    INVALID_SIZE = 4,
+    PAYLOAD_SIZE_MISMATCH = 5,
+    CRC_MISMATCH = 6,
+    MALFORMED_PAYLOAD = 7
+};
+
+//Per call site limiter behind LOG/LOG_CODE while an asynchronous backend is installed: at most
+//LOG_RATE_LIMIT messages per second, the rest are counted and the count is handed to the next message
+//that gets through. The clock is read on a site's first message and then only once it has used up
+//its allowance; running out in a later second than the allowance began opens a new one.
+class LogRateLimiter {
+private:
+    std::atomic<uint64_t> window{0}; //second in which the current allowance began
+    std::atomic<uint32_t> emitted{0};
+    std::atomic<uint32_t> suppressed{0};
+
+public:
+    constexpr LogRateLimiter() = default;
+
+    static uint64_t nowSecond() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    bool allow() {
+#if LOG_RATE_LIMIT > 0
+        const uint32_t count = emitted.fetch_add(1, std::memory_order_relaxed);
+        if (count == 0) window.store(nowSecond(), std::memory_order_relaxed);
+        if (count < LOG_RATE_LIMIT) return true;
+
+        const uint64_t second = nowSecond();
+        uint64_t current = window.load(std::memory_order_relaxed);
+        if (current != second && window.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+            //A new second: this message opens a fresh allowance
+            emitted.store(1, std::memory_order_relaxed);
+            return true;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    uint32_t takeSuppressed() {
+        return suppressed.exchange(0, std::memory_order_relaxed);
+    }
+};
+
 class Logger {
 public:
     using LogCallback = void (*)(LogLevel level, const char *message);
+    //Hot-path hook installed by an asynchronous backend (see AsyncLogger)
+    using RecordSink = void (*)(LogLevel level, LogCode code, const char *message,
+                                uint32_t arg0, uint32_t arg1, uint32_t suppressed);
 
 #if LOGGING_ENABLED
+    //The callback may be invoked from several threads at once and must be thread-safe itself
     static void setCallback(LogCallback cb) {
-        getCallback() = cb;
+        getCallback().store(cb, std::memory_order_release);
+    }
+
+    static void setRecordSink(RecordSink sink) {
+        getSink().store(sink, std::memory_order_release);
+    }
+
+    static bool hasRecordSink() {
+        return getSink().load(std::memory_order_relaxed) != nullptr;
+    }
+
+    //message must outlive the call when a record sink is installed; LOG call sites pass literals
+    static void log(LogLevel level, LogCode code, const char *message,
+                    uint32_t arg0 = 0, uint32_t arg1 = 0, uint32_t suppressed = 0) {
+        if (const RecordSink sink = getSink().load(std::memory_order_acquire)) {
+            sink(level, code, message, arg0, arg1, suppressed);
+        } else {
+            write(level, message);
+        }
     }
 
     static void log(LogLevel level, const char *message) {
-        if (getCallback()) getCallback()(level, message);
+        log(level, LogCode::NONE, message);
+    }
+
+    //Straight to the callback, bypassing any record sink
+    static void write(LogLevel level, const char *message) {
+        if (const LogCallback cb = getCallback().load(std::memory_order_acquire)) cb(level, message);
     }
 
 private:
-    static LogCallback &getCallback() {
-        static LogCallback instance = nullptr;
+    static std::atomic<LogCallback> &getCallback() {
+        static std::atomic<LogCallback> instance{nullptr};
+        return instance;
+    }
+
+    static std::atomic<RecordSink> &getSink() {
+        static std::atomic<RecordSink> instance{nullptr};
         return instance;
     }
 #else
     static void setCallback(LogCallback) {
     }
+    static void setRecordSink(RecordSink) {
+    }
+    static void log(LogLevel, LogCode, const char *, uint32_t = 0, uint32_t = 0, uint32_t = 0) {
+    }
     static void log(LogLevel, const char *) {
     }
+    static void write(LogLevel, const char *) {
+    }
 #endif
 };
 
 #if LOGGING_ENABLED
-    #define LOG(level, msg) Logger::log(level, msg)
+    //Levels below LOG_MIN_LEVEL compile to nothing; synchronous logging is never rate limited
+    #define LOG_CODE(level, code, msg, arg0, arg1) \
+        do { \
+            if (static_cast<int>(level) >= LOG_MIN_LEVEL) { \
+                static LogRateLimiter logSite; \
+                if (!Logger::hasRecordSink()) Logger::log(level, code, msg, arg0, arg1); \
+                else if (logSite.allow()) Logger::log(level, code, msg, arg0, arg1, logSite.takeSuppressed()); \
+            } \
+        } while (0)
 #else
-    #define LOG(level, msg) ((void)0)
+    #define LOG_CODE(level, code, msg, arg0, arg1) ((void)0)
 #endif
 
+#define LOG(level, msg) LOG_CODE(level, LogCode::NONE, msg, 0, 0)
+
 #endif //SMARTDRIVE_LOGGER_H
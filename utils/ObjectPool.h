@@ -0,0 +1,376 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_OBJECTPOOL_H
+#define SMARTDRIVE_OBJECTPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//Size-class pools for small objects that outlive a decode call (TelemetryData, SettingsData,
+//Command, frame copies). Each thread allocates from and frees into its own cache of free blocks;
+//the shared free list is only touched, under a mutex, to move CACHE_BATCH blocks at a time, and
+//the heap only when that list runs dry. Blocks are never handed back to the heap, so once a
+//workload has reached its peak, allocation and free cost a few pointer moves.
+namespace ObjectPool {
+    constexpr size_t CLASSES = 4;
+    constexpr size_t MIN_BLOCK_SIZE = 32;
+    constexpr size_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << (CLASSES - 1);
+    constexpr size_t SLAB_SIZE = 64 * 1024;
+    constexpr size_t CACHE_BATCH = 64;
+    constexpr size_t BLOCK_ALIGNMENT = 16;
+
+    constexpr size_t blockSize(const size_t sizeClass) { return MIN_BLOCK_SIZE << sizeClass; }
+
+    constexpr size_t classOf(const size_t size) {
+        size_t c = 0;
+        while (c < CLASSES && blockSize(c) < size) c++;
+        return c; //CLASSES: too large for the pools
+    }
+
+    struct Stats {
+        struct Class {
+            size_t blockSize = 0;
+            uint64_t live = 0;
+            //Blocks taken from the heap. Pools never shrink, so this is the high-water mark of pool memory.
+            uint64_t reserved = 0;
+        } classes[CLASSES];
+        uint64_t heapFallbacks = 0; //allocations larger than MAX_BLOCK_SIZE
+    };
+
+    namespace detail {
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        inline void bump(std::atomic<uint64_t> &counter, const uint64_t n) {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        struct alignas(64) ThreadCache;
+
+        struct Central {
+            std::mutex mutex;
+            FreeBlock *free[CLASSES] = {};
+            size_t freeCount[CLASSES] = {};
+            uint64_t reserved[CLASSES] = {};
+            std::vector<std::unique_ptr<uint8_t[]> > slabs;
+            std::vector<ThreadCache *> caches;
+            //Counters of threads that have exited
+            uint64_t retiredAllocated[CLASSES] = {};
+            uint64_t retiredFreed[CLASSES] = {};
+            std::atomic<uint64_t> heapFallbacks{0};
+
+            static Central &instance() {
+                static Central central;
+                return central;
+            }
+
+            //Moves up to count blocks of sizeClass onto list; caller holds mutex
+            size_t take(const size_t sizeClass, FreeBlock *&list, const size_t count) {
+                if (freeCount[sizeClass] < count) carve(sizeClass);
+                size_t moved = 0;
+                while (moved < count && free[sizeClass]) {
+                    FreeBlock *block = free[sizeClass];
+                    free[sizeClass] = block->next;
+                    block->next = list;
+                    list = block;
+                    moved++;
+                }
+                freeCount[sizeClass] -= moved;
+                return moved;
+            }
+
+            void give(const size_t sizeClass, FreeBlock *first, FreeBlock *last, const size_t count) {
+                last->next = free[sizeClass];
+                free[sizeClass] = first;
+                freeCount[sizeClass] += count;
+            }
+
+        private:
+            void carve(const size_t sizeClass) {
+                const size_t size = blockSize(sizeClass);
+                const size_t blocks = SLAB_SIZE / size;
+                slabs.emplace_back(new uint8_t[SLAB_SIZE + BLOCK_ALIGNMENT]);
+                auto base = reinterpret_cast<uintptr_t>(slabs.back().get());
+                base = (base + BLOCK_ALIGNMENT - 1) & ~static_cast<uintptr_t>(BLOCK_ALIGNMENT - 1);
+                for (size_t i = blocks; i-- > 0;) {
+                    auto *block = reinterpret_cast<FreeBlock *>(base + i * size);
+                    block->next = free[sizeClass];
+                    free[sizeClass] = block;
+                }
+                freeCount[sizeClass] += blocks;
+                reserved[sizeClass] += blocks;
+            }
+        };
+
+        struct alignas(64) ThreadCache {
+            FreeBlock *free[CLASSES] = {};
+            size_t count[CLASSES] = {};
+            //Written only by the owning thread; read by stats()
+            std::atomic<uint64_t> allocated[CLASSES] = {};
+            std::atomic<uint64_t> freed[CLASSES] = {};
+
+            ThreadCache() {
+                Central &central = Central::instance();
+                std::lock_guard<std::mutex> lock(central.mutex);
+                central.caches.push_back(this);
+            }
+
+            ~ThreadCache() {
+                Central &central = Central::instance();
+                std::lock_guard<std::mutex> lock(central.mutex);
+                for (size_t c = 0; c < CLASSES; ++c) {
+                    if (free[c]) {
+                        FreeBlock *last = free[c];
+                        while (last->next) last = last->next;
+                        central.give(c, free[c], last, count[c]);
+                    }
+                    central.retiredAllocated[c] += allocated[c].load(std::memory_order_relaxed);
+                    central.retiredFreed[c] += freed[c].load(std::memory_order_relaxed);
+                }
+                for (size_t i = 0; i < central.caches.size(); ++i) {
+                    if (central.caches[i] == this) {
+                        central.caches[i] = central.caches.back();
+                        central.caches.pop_back();
+                        break;
+                    }
+                }
+            }
+
+            void *allocate(const size_t sizeClass) {
+                if (!free[sizeClass]) {
+                    Central &central = Central::instance();
+                    std::lock_guard<std::mutex> lock(central.mutex);
+                    count[sizeClass] += central.take(sizeClass, free[sizeClass], CACHE_BATCH);
+                }
+                FreeBlock *block = free[sizeClass];
+                free[sizeClass] = block->next;
+                count[sizeClass]--;
+                bump(allocated[sizeClass], 1);
+                return block;
+            }
+
+            void deallocate(void *p, const size_t sizeClass) {
+                auto *block = static_cast<FreeBlock *>(p);
+                block->next = free[sizeClass];
+                free[sizeClass] = block;
+                count[sizeClass]++;
+                bump(freed[sizeClass], 1);
+                if (count[sizeClass] >= 2 * CACHE_BATCH) {
+                    //Hand half back so a thread that only frees (a consumer) does not hoard blocks
+                    FreeBlock *last = free[sizeClass];
+                    for (size_t i = 1; i < CACHE_BATCH; ++i) last = last->next;
+                    FreeBlock *rest = last->next;
+                    Central &central = Central::instance();
+                    std::lock_guard<std::mutex> lock(central.mutex);
+                    central.give(sizeClass, free[sizeClass], last, CACHE_BATCH);
+                    free[sizeClass] = rest;
+                    count[sizeClass] -= CACHE_BATCH;
+                }
+            }
+        };
+
+        inline ThreadCache &local() {
+            thread_local ThreadCache cache;
+            return cache;
+        }
+    }
+
+    inline void *allocate(const size_t size) {
+        const size_t sizeClass = classOf(size);
+        if (sizeClass == CLASSES) {
+            detail::Central::instance().heapFallbacks.fetch_add(1, std::memory_order_relaxed);
+            return ::operator new(size);
+        }
+        return detail::local().allocate(sizeClass);
+    }
+
+    //size must be the size passed to allocate(); p may come from any thread
+    inline void deallocate(void *p, const size_t size) {
+        if (!p) return;
+        const size_t sizeClass = classOf(size);
+        if (sizeClass == CLASSES) {
+            ::operator delete(p);
+            return;
+        }
+        detail::local().deallocate(p, sizeClass);
+    }
+
+    inline Stats stats() {
+        Stats s;
+        detail::Central &central = detail::Central::instance();
+        std::lock_guard<std::mutex> lock(central.mutex);
+        for (size_t c = 0; c < CLASSES; ++c) {
+            uint64_t allocated = central.retiredAllocated[c], freed = central.retiredFreed[c];
+            for (const detail::ThreadCache *cache : central.caches) {
+                allocated += cache->allocated[c].load(std::memory_order_relaxed);
+                freed += cache->freed[c].load(std::memory_order_relaxed);
+            }
+            s.classes[c].blockSize = blockSize(c);
+            s.classes[c].live = allocated - freed;
+            s.classes[c].reserved = central.reserved[c];
+        }
+        s.heapFallbacks = central.heapFallbacks.load(std::memory_order_relaxed);
+        return s;
+    }
+}
+
+//Owning handle to a pool-allocated T; destroys it and returns the block on any thread
+template<typename T>
+class PoolPtr {
+    static_assert(alignof(T) <= ObjectPool::BLOCK_ALIGNMENT, "Pool blocks are only 16-byte aligned");
+
+private:
+    T *object = nullptr;
+
+public:
+    PoolPtr() = default;
+    explicit PoolPtr(T *pooled) : object(pooled) {}
+
+    PoolPtr(PoolPtr &&other) noexcept : object(other.object) { other.object = nullptr; }
+
+    PoolPtr &operator=(PoolPtr &&other) noexcept {
+        if (this != &other) {
+            reset();
+            object = other.object;
+            other.object = nullptr;
+        }
+        return *this;
+    }
+
+    PoolPtr(const PoolPtr &) = delete;
+    PoolPtr &operator=(const PoolPtr &) = delete;
+
+    ~PoolPtr() { reset(); }
+
+    void reset() {
+        if (!object) return;
+        object->~T();
+        ObjectPool::deallocate(object, sizeof(T));
+        object = nullptr;
+    }
+
+    T *get() const { return object; }
+    T &operator*() const { return *object; }
+    T *operator->() const { return object; }
+    explicit operator bool() const { return object != nullptr; }
+};
+
+namespace ObjectPool {
+    template<typename T, typename... Args>
+    PoolPtr<T> make(Args &&... args) {
+        return PoolPtr<T>(new(allocate(sizeof(T))) T(std::forward<Args>(args)...));
+    }
+}
+
+//Bump allocator for everything decoded from one batch. Objects are never freed one by one;
+//reset() releases the whole batch in O(1) and keeps the blocks for the next one, so a
+//steady-state loop stops touching the heap after its first few batches. Not thread-safe: use
+//one arena per decode thread.
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t size;
+    };
+
+    std::vector<Block> blocks;
+    size_t blockSize;
+    size_t current = 0; //index of the block being filled
+    size_t offset = 0;
+    size_t used = 0;
+    size_t peak = 0;
+
+public:
+    explicit FrameArena(const size_t blockSize = DEFAULT_BLOCK_SIZE) : blockSize(blockSize) {
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(const size_t size, const size_t alignment = alignof(std::max_align_t)) {
+        for (;;) {
+            if (current < blocks.size()) {
+                const auto base = reinterpret_cast<uintptr_t>(blocks[current].memory.get());
+                const size_t aligned = ((base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+                if (aligned + size <= blocks[current].size) {
+                    offset = aligned + size;
+                    used += size;
+                    if (used > peak) peak = used;
+                    return reinterpret_cast<void *>(base + aligned);
+                }
+                if (offset > 0 || blocks[current].size >= size + alignment) {
+                    current++;
+                    offset = 0;
+                    continue;
+                }
+                //This block can never hold the request; replace it with one that can
+                blocks[current] = {std::unique_ptr<uint8_t[]>(new uint8_t[size + alignment]), size + alignment};
+                continue;
+            }
+            const size_t bytes = size + alignment > blockSize ? size + alignment : blockSize;
+            blocks.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[bytes]), bytes});
+        }
+    }
+
+    //Objects are not destroyed by reset(), so only trivially destructible types may live here
+    template<typename T, typename... Args>
+    T *make(Args &&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+        return new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    uint8_t *copy(const uint8_t *data, const size_t size) {
+        auto *out = static_cast<uint8_t *>(allocate(size, 1));
+        memcpy(out, data, size);
+        return out;
+    }
+
+    void reset() {
+        current = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t highWater() const { return peak; }
+    size_t blockCount() const { return blocks.size(); }
+};
+
+//std allocator over a FrameArena, for containers whose lifetime is one batch
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    FrameArena *arena;
+
+    explicit ArenaAllocator(FrameArena &arena) : arena(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(const size_t n) { return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+};
+
+#endif //SMARTDRIVE_OBJECTPOOL_H
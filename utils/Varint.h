@@ -0,0 +1,52 @@
+//
+// Created by dunamis on 16/10/2026.
+//
+
+#ifndef SMARTDRIVE_VARINT_H
+#define SMARTDRIVE_VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+
+//LEB128-style unsigned varints (7 bits per byte, low group first) and zig-zag mapping for signed deltas
+namespace Varint {
+    constexpr size_t MAX_SIZE_32 = 5;
+
+    constexpr uint32_t zigzagEncode(const int32_t value) {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    constexpr int32_t zigzagDecode(const uint32_t value) {
+        return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    //Returns bytes written; dest must have room for MAX_SIZE_32 bytes
+    inline size_t write(uint8_t *dest, uint32_t value) {
+        size_t length = 0;
+        while (value >= 0x80) {
+            dest[length++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        dest[length++] = static_cast<uint8_t>(value);
+        return length;
+    }
+
+    //Returns bytes consumed, or 0 if the varint is truncated or longer than 32 bits
+    inline size_t read(const uint8_t *src, const size_t available, uint32_t &value) {
+        uint32_t result = 0;
+        for (size_t i = 0; i < available && i < MAX_SIZE_32; ++i) {
+            const uint8_t byte = src[i];
+            if (i == MAX_SIZE_32 - 1 && byte > 0x0F) {
+                return 0;
+            }
+            result |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+            if ((byte & 0x80) == 0) {
+                value = result;
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+}
+
+#endif //SMARTDRIVE_VARINT_H